@@ -0,0 +1,52 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "min_annulus_solver.h"
+
+// Compares the approximate solve on a core set with the exact one on noisy rings and random points
+// To run: ./approx_bench [max_n] [eps]
+// The exact solve is skipped past 10^5 points, where it takes seconds
+
+int main(int argc, char* argv[]) {
+    int max_n = (argc > 1) ? atoi(argv[1]) : 1000000;
+    double eps = (argc > 2) ? atof(argv[2]) : 1e-3;
+
+    struct Workload {
+        std::string name;
+        std::vector<geometry::Point> (*generate)(int, std::mt19937*);
+    };
+    std::vector<Workload> workloads = {
+        {"ring", [](int n, std::mt19937* rng) { return bench::Ring(n, rng); }}, {"random", bench::Random}};
+
+    MinAnnulusSolver solver;
+    printf("%-8s %8s %12s %12s %12s %8s %10s %10s\n", "workload", "n", "lower", "upper", "exact", "core",
+           "approx_ms", "exact_ms");
+    for (const Workload& workload : workloads) {
+        for (int n = 1000; n <= max_n; n *= 10) {
+            std::mt19937 rng(n);
+            std::vector<geometry::Point> points = workload.generate(n, &rng);
+
+            auto start = std::chrono::steady_clock::now();
+            MinAnnulusSolver::ApproxAnnulus approx = solver.SolveApprox(points, eps);
+            double approx_secs = SecondsSince(start);
+
+            double exact = -1, exact_secs = -1;
+            if (n <= 100000) {
+                start = std::chrono::steady_clock::now();
+                geometry::Annulus ann = solver.Solve(points);
+                exact_secs = SecondsSince(start);
+                exact = ann.r_outer - ann.r_inner;
+            }
+            printf("%-8s %8d %12.6f %12.6f %12.6f %8d %10.1f %10.1f%s\n", workload.name.c_str(), n, approx.lower,
+                   approx.upper, exact, approx.core_size, approx_secs * 1e3, exact_secs * 1e3,
+                   approx.converged ? "" : "  not converged");
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
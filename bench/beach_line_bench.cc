@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "model.h"
+#include "voronoi.h"
+
+// Times Fortune's sweep alone on inputs that are adversarial for an unbalanced beach line
+// To run: ./beach_line_bench [max_n]
+
+namespace {
+
+// Sites sorted by x on a convex descending curve, swept in x order so every new arc lands at the right end
+std::vector<geometry::Point> SortedDiagonal(int n, std::mt19937* rng) {
+    std::uniform_real_distribution<double> noise(0, 0.5);
+    std::vector<geometry::Point> points;
+    for (int i = 0; i < n; i++) {
+        double x = i + noise(*rng);
+        points.push_back({x, -1.5 * x - x * x / n, i});
+    }
+    return points;
+}
+
+// Angularly sorted samples of a slightly noisy circle, the beach line grows at both ends
+std::vector<geometry::Point> SortedCircle(int n, std::mt19937* rng) {
+    std::uniform_real_distribution<double> noise(-1e-3, 1e-3);
+    std::vector<geometry::Point> points;
+    for (int i = 0; i < n; i++) {
+        double alpha = 2 * M_PI * i / n;
+        double r = 1000 * (1 + noise(*rng));
+        points.push_back({r * cos(alpha), r * sin(alpha), i});
+    }
+    return points;
+}
+
+double TimeFortunes(const std::vector<geometry::Point>& points) {
+    Model model(points);
+    model.SetVisualize(false);
+    auto start = std::chrono::steady_clock::now();
+    Voronoi voronoi(&model);
+    voronoi.ComputeDiagram(std::launch::deferred).get();
+    return SecondsSince(start);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int max_n = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+    struct Workload {
+        std::string name;
+        std::vector<geometry::Point> (*generate)(int, std::mt19937*);
+    };
+    std::vector<Workload> workloads = {
+        {"sorted_diagonal", SortedDiagonal}, {"sorted_circle", SortedCircle}, {"random", bench::Random}};
+
+    // Quadratic behaviour shows up as a 100x jump per 10x step in n
+    printf("%-16s %10s %12s %14s\n", "workload", "n", "seconds", "us_per_site");
+    for (const Workload& workload : workloads) {
+        for (int n = 1000; n <= max_n; n *= 10) {
+            std::mt19937 rng(n);
+            std::vector<geometry::Point> points = workload.generate(n, &rng);
+            double secs = TimeFortunes(points);
+            printf("%-16s %10d %12.3f %14.3f\n", workload.name.c_str(), n, secs, secs * 1e6 / n);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
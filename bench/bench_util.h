@@ -0,0 +1,47 @@
+#pragma once
+#include <cmath>
+#include <random>
+#include <vector>
+#include "geometry.h"
+#include "stage_times.h"
+
+// Inputs shared by the benchmarks, the timer is SecondsSince from stage_times.h
+namespace bench {
+
+// Uniform in a 1000 x 1000 square
+inline std::vector<geometry::Point> Random(int n, std::mt19937* rng) {
+    std::uniform_real_distribution<double> coord(0, 1000);
+    std::vector<geometry::Point> points;
+    for (int i = 0; i < n; i++) {
+        points.push_back({coord(*rng), coord(*rng), i});
+    }
+    return points;
+}
+
+// A circle of radius 1000 with relative radial noise up to 'noise', all on the hull up to rounding when it is 0
+inline std::vector<geometry::Point> Circle(int n, std::mt19937* rng, double noise) {
+    std::uniform_real_distribution<double> alpha(0, 2 * M_PI);
+    std::uniform_real_distribution<double> dr(-noise, noise);
+    std::vector<geometry::Point> points;
+    for (int i = 0; i < n; i++) {
+        double a = alpha(*rng);
+        double r = 1000 * (1 + dr(*rng));
+        points.push_back({r * cos(a), r * sin(a), i});
+    }
+    return points;
+}
+
+// A ring of radius 50 with radial noise and a few lobes, like a turned part
+inline std::vector<geometry::Point> Ring(int n, std::mt19937* rng, int lobes = 3) {
+    std::uniform_real_distribution<double> alpha(0, 2 * M_PI);
+    std::uniform_real_distribution<double> noise(-0.01, 0.01);
+    std::vector<geometry::Point> points;
+    for (int i = 0; i < n; i++) {
+        double a = alpha(*rng);
+        double r = 50 + 0.02 * cos(lobes * a) + noise(*rng);
+        points.push_back({r * cos(a), r * sin(a), i});
+    }
+    return points;
+}
+
+}  // namespace bench
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "annulus_finder.h"
+#include "bench_util.h"
+#include "fp_voronoi.h"
+#include "model.h"
+#include "stage_times.h"
+#include "voronoi.h"
+
+// Times the overlay and the intersection candidates on inputs with every point on the hull, where both
+// diagrams have a halfline per point. Pairs are only tested where the walk meets them, so the time per
+// site should stay nearly flat as n doubles
+// To run: ./crossing_pairs_bench [max_n]
+
+namespace {
+
+// Evenly spread angles with some jitter and radial noise well below the sagitta, so the points stay
+// in convex position without being cocircular
+std::vector<geometry::Point> OnHull(int n, std::mt19937* rng) {
+    double step = 2 * M_PI / n;
+    double sagitta = 1000 * (1 - cos(step / 2));
+    std::uniform_real_distribution<double> jitter(-0.25 * step, 0.25 * step);
+    std::uniform_real_distribution<double> noise(-0.1 * sagitta, 0.1 * sagitta);
+    std::vector<geometry::Point> points;
+    for (int i = 0; i < n; i++) {
+        double alpha = i * step + jitter(*rng);
+        double r = 1000 + noise(*rng);
+        points.push_back({r * cos(alpha), r * sin(alpha), i});
+    }
+    std::shuffle(points.begin(), points.end(), *rng);
+    for (int i = 0; i < n; i++) {
+        points[i].idx = i;
+    }
+    return points;
+}
+
+StageTimes TimeStages(const std::vector<geometry::Point>& points) {
+    Model model(points);
+    model.SetVisualize(false);
+    Voronoi voronoi(&model);
+    std::future<void> v_fut = voronoi.ComputeDiagram(std::launch::deferred);
+    FarthestPointVoronoi fp_voronoi(&model);
+    std::future<void> fpv_fut = fp_voronoi.ComputeDiagram(std::launch::deferred);
+    AnnulusFinder annulus_finder(&v_fut, &fpv_fut, &model);
+    annulus_finder.FindAnnulus(std::launch::deferred).get();
+    return *model.GetStageTimes();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int max_n = (argc > 1) ? atoi(argv[1]) : 64000;
+
+    struct Workload {
+        std::string name;
+        std::vector<geometry::Point> (*generate)(int, std::mt19937*);
+    };
+    std::vector<Workload> workloads = {{"on_hull", OnHull}, {"random", bench::Random}};
+
+    // Quadratic behaviour shows up as us_per_site doubling with n
+    printf("%-10s %8s %12s %12s %14s\n", "workload", "n", "overlay", "type3", "us_per_site");
+    for (const Workload& workload : workloads) {
+        for (int n = 2000; n <= max_n; n *= 2) {
+            std::mt19937 rng(n);
+            StageTimes times = TimeStages(workload.generate(n, &rng));
+            double secs = times.overlay + times.candidates[2];
+            printf("%-10s %8d %12.3f %12.3f %14.3f\n", workload.name.c_str(), n, times.overlay, times.candidates[2],
+                   secs * 1e6 / n);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
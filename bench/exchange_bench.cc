@@ -0,0 +1,55 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "bench_util.h"
+#include "exchange_solver.h"
+#include "min_annulus_solver.h"
+
+// Compares the exchange engine with the diagrams on rings with noise and a few lobes, like turned parts
+// To run: ./exchange_bench [max_n] [seeds]
+// The diagrams are skipped past 10^5 points, where they take seconds
+
+int main(int argc, char* argv[]) {
+    int max_n = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int seeds = (argc > 2) ? atoi(argv[2]) : 5;
+
+    // 'solved' counts the seeds the exchange finished on its own, 'same' the ones where it agrees with the
+    // diagrams bit for bit
+    printf("%8s %6s %8s %8s %8s %12s %12s\n", "n", "lobes", "solved", "same", "iters", "exchange_ms",
+           "diagrams_ms");
+    MinAnnulusSolver diagrams;
+    for (int n = 1000; n <= max_n; n *= 10) {
+        for (int lobes : {2, 3, 5}) {
+            int solved = 0, same = 0, iters = 0;
+            double exchange_secs = 0, diagrams_secs = 0;
+            for (int seed = 0; seed < seeds; seed++) {
+                std::mt19937 rng(n * 100 + lobes * 10 + seed);
+                std::vector<geometry::Point> points = bench::Ring(n, &rng, lobes);
+
+                auto start = std::chrono::steady_clock::now();
+                ExchangeSolver exchange(points);
+                geometry::Annulus ann;
+                bool ok = exchange.Solve(&ann);
+                exchange_secs += SecondsSince(start);
+                solved += ok;
+                iters += exchange.GetIterations();
+
+                if (n <= 100000) {
+                    start = std::chrono::steady_clock::now();
+                    geometry::Annulus ref = diagrams.Solve(points);
+                    diagrams_secs += SecondsSince(start);
+                    same += ok && ann.center.x == ref.center.x && ann.center.y == ref.center.y &&
+                            ann.r_inner == ref.r_inner && ann.r_outer == ref.r_outer;
+                }
+            }
+            printf("%8d %6d %8d %8d %8.1f %12.2f %12.2f\n", n, lobes, solved, same,
+                   static_cast<double>(iters) / seeds, exchange_secs * 1e3 / seeds,
+                   (n <= 100000) ? diagrams_secs * 1e3 / seeds : -1.0);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "bench_util.h"
+#include "incremental_solver.h"
+#include "min_annulus_solver.h"
+
+// Times adding probe points to a solved ring against solving everything again
+// To run: ./incremental_bench [n] [batches] [k]
+// Probes mostly land inside the annulus, every tenth batch has one that sticks out of it
+
+namespace {
+
+geometry::Point OnRing(double r, std::mt19937* rng) {
+    std::uniform_real_distribution<double> alpha(0, 2 * M_PI);
+    double a = alpha(*rng);
+    return {r * cos(a), r * sin(a), 0};
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 20000;
+    int batches = (argc > 2) ? atoi(argv[2]) : 50;
+    int k = (argc > 3) ? atoi(argv[3]) : 10;
+
+    std::mt19937 rng(n);
+    std::uniform_real_distribution<double> noise(-0.01, 0.01);
+    std::vector<geometry::Point> points;
+    for (int i = 0; i < n; i++) {
+        points.push_back(OnRing(50 + noise(rng), &rng));
+    }
+
+    MinAnnulusSolver solver;
+    IncrementalSolver incremental(solver);
+    auto start = std::chrono::steady_clock::now();
+    incremental.Solve(points);
+    double first_secs = SecondsSince(start);
+
+    double add_secs = 0, full_secs = 0;
+    int mismatches = 0;
+    for (int b = 0; b < batches; b++) {
+        std::vector<geometry::Point> probes;
+        for (int i = 0; i < k; i++) {
+            double r = (b % 10 == 9 && i == 0) ? 50.05 : 50 + noise(rng) / 2;
+            probes.push_back(OnRing(r, &rng));
+        }
+        points.insert(points.end(), probes.begin(), probes.end());
+
+        start = std::chrono::steady_clock::now();
+        geometry::Annulus ann = incremental.AddPointsOrResolve(probes);
+        add_secs += SecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        geometry::Annulus ref = solver.Solve(points);
+        full_secs += SecondsSince(start);
+        mismatches += ann.r_outer - ann.r_inner != ref.r_outer - ref.r_inner;
+    }
+
+    printf("n = %d, %d batches of %d probes\n", n, batches, k);
+    printf("first solve     %10.2f ms\n", first_secs * 1e3);
+    printf("add per batch   %10.3f ms (%d solves again)\n", add_secs * 1e3 / batches,
+           incremental.GetSolveCount() - 1);
+    printf("full per batch  %10.3f ms\n", full_secs * 1e3 / batches);
+    printf("width mismatches %d\n", mismatches);
+    return 0;
+}
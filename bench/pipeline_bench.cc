@@ -0,0 +1,144 @@
+#include <sys/resource.h>
+#include <unistd.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "annulus_finder.h"
+#include "bench_util.h"
+#include "fp_voronoi.h"
+#include "model.h"
+#include "point_io.h"
+#include "stage_times.h"
+#include "thread_pool.h"
+#include "voronoi.h"
+
+// Runs the whole pipeline on generated inputs of 10^2 up to 'max_n' points and times every stage
+// To run: ./pipeline_bench [max_n] [json_path]
+// The inputs are written as text and loaded back, so loading is timed too. Candidate times are summed over
+// threads. Peak RSS is the peak of the process so far; runs go by increasing n, so it belongs to the
+// biggest run yet. With 'json_path', all runs are also written there as JSON
+
+namespace {
+
+struct Run {
+    std::string workload;
+    int n;
+    double load, total;
+    StageTimes times;
+    long peak_rss_kb;
+    double width;
+};
+
+// Uniform in a square, or a noisy ring with three lobes like a turned part
+std::vector<geometry::Point> Generate(const std::string& workload, int n) {
+    std::mt19937 rng(n);
+    return (workload == "uniform") ? bench::Random(n, &rng) : bench::Ring(n, &rng);
+}
+
+bool WriteText(const std::string& path, const std::vector<geometry::Point>& points) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) return false;
+    fprintf(file, "%d\n", static_cast<int>(points.size()));
+    for (const geometry::Point& pt : points) {
+        fprintf(file, "%.17g %.17g\n", pt.x, pt.y);
+    }
+    return fclose(file) == 0;
+}
+
+long PeakRssKb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+bool Measure(const std::string& workload, int n, Run* run) {
+    std::string path = "/tmp/pipeline_bench_" + std::to_string(getpid()) + ".in";
+    if (!WriteText(path, Generate(workload, n))) return false;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<geometry::Point> points;
+    bool loaded = point_io::LoadText(path, &points, 0);
+    run->load = SecondsSince(start);
+    unlink(path.c_str());
+    if (!loaded) return false;
+
+    // Same as MinAnnulusSolver::Solve, but with the model at hand
+    start = std::chrono::steady_clock::now();
+    Model model(points);
+    model.SetVisualize(false);
+    model.SetNumThreads(ThreadPool::DefaultNumThreads());
+    Voronoi voronoi(&model);
+    std::future<void> v_fut = voronoi.ComputeDiagram(std::launch::deferred);
+    FarthestPointVoronoi fp_voronoi(&model);
+    std::future<void> fpv_fut = fp_voronoi.ComputeDiagram(std::launch::deferred);
+    AnnulusFinder annulus_finder(&v_fut, &fpv_fut, &model);
+    annulus_finder.FindAnnulus(std::launch::deferred).get();
+    run->total = SecondsSince(start);
+
+    run->workload = workload;
+    run->n = n;
+    run->times = *model.GetStageTimes();
+    run->peak_rss_kb = PeakRssKb();
+    run->width = model.GetAnnulus()->r_outer - model.GetAnnulus()->r_inner;
+    return true;
+}
+
+void WriteJson(const std::string& path, const std::vector<Run>& runs) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        printf("Error: cannot write %s\n", path.c_str());
+        return;
+    }
+    fprintf(file, "{\n  \"benchmark\": \"pipeline\",\n  \"runs\": [\n");
+    for (int i = 0; i < static_cast<int>(runs.size()); i++) {
+        const Run& run = runs[i];
+        const StageTimes& t = run.times;
+        fprintf(file, "    {\"workload\": \"%s\", \"n\": %d, \"width\": %.17g, \"peak_rss_kb\": %ld, \"seconds\": {",
+                run.workload.c_str(), run.n, run.width, run.peak_rss_kb);
+        fprintf(file, "\"load\": %.9f, \"hull\": %.9f, \"fortune\": %.9f, \"fp_incremental\": %.9f, ", run.load, t.hull,
+                t.fortune, t.fp_incremental);
+        fprintf(file, "\"add_box\": %.9f, \"locators\": %.9f, \"overlay\": %.9f, ", t.voronoi_box + t.fp_voronoi_box,
+                t.locators, t.overlay);
+        fprintf(file, "\"candidates_type1\": %.9f, \"candidates_type2\": %.9f, \"candidates_type3\": %.9f, ",
+                t.candidates[0], t.candidates[1], t.candidates[2]);
+        fprintf(file, "\"reduction\": %.9f, \"total\": %.9f}}%s\n", t.reduction, run.total,
+                (i + 1 < static_cast<int>(runs.size())) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int max_n = (argc > 1) ? atoi(argv[1]) : 100000;
+    std::string json_path = (argc > 2) ? argv[2] : "";
+
+    // All times in ms
+    printf("%-8s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s %9s %8s\n", "workload", "n", "load", "hull",
+           "fortune", "fp_incr", "add_box", "locators", "overlay", "cand1", "cand2", "cand3", "reduce", "total",
+           "rss_mb");
+    std::vector<Run> runs;
+    for (long n = 100; n <= max_n; n *= 10) {
+        for (const char* workload : {"uniform", "ring"}) {
+            Run run;
+            if (!Measure(workload, n, &run)) {
+                printf("Error: cannot write or load the %s input of %ld points\n", workload, n);
+                return 1;
+            }
+            const StageTimes& t = run.times;
+            printf("%-8s %8d %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %9.2f %8.1f\n",
+                   workload, run.n, run.load * 1e3, t.hull * 1e3, t.fortune * 1e3, t.fp_incremental * 1e3,
+                   (t.voronoi_box + t.fp_voronoi_box) * 1e3, t.locators * 1e3, t.overlay * 1e3,
+                   t.candidates[0] * 1e3, t.candidates[1] * 1e3, t.candidates[2] * 1e3, t.reduction * 1e3,
+                   run.total * 1e3, run.peak_rss_kb / 1024.0);
+            fflush(stdout);
+            runs.push_back(run);
+        }
+    }
+    if (!json_path.empty()) WriteJson(json_path, runs);
+    return 0;
+}
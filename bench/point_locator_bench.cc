@@ -0,0 +1,115 @@
+#include <malloc.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "model.h"
+#include "point_locator.h"
+#include "voronoi.h"
+#include "walking_locator.h"
+
+// Compares the slab and the trapezoidal map locators on the Voronoi diagram of large inputs
+// To run: ./point_locator_bench [max_n]
+// The slab locator needs quadratic memory in the worst case, it takes gigabytes past ~50000 sites
+
+namespace {
+
+// Bytes in use on the heap, big blocks are mapped separately
+size_t HeapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+struct Result {
+    double build_secs, query_us, batch_us, mbytes;
+    std::vector<int> answers, batch_answers;
+};
+
+// Builds a locator and answers all queries, memory is what the locator holds on to after the build
+// Takes ownership of the locator
+Result Run(PointLocator* locator, Dcel* dcel, const std::vector<geometry::Point>& queries) {
+    Result result;
+    size_t before = HeapInUse();
+    auto start = std::chrono::steady_clock::now();
+    locator->LoadDcel(dcel);
+    result.build_secs = SecondsSince(start);
+    result.mbytes = (HeapInUse() - before) / 1e6;
+
+    start = std::chrono::steady_clock::now();
+    for (const geometry::Point& pt : queries) {
+        result.answers.push_back(locator->Locate(pt));
+    }
+    result.query_us = SecondsSince(start) * 1e6 / queries.size();
+
+    // The same queries as one batch, on a single thread to compare with the loop above
+    result.batch_answers.resize(queries.size());
+    start = std::chrono::steady_clock::now();
+    locator->LocateBatch(queries.data(), queries.size(), result.batch_answers.data());
+    result.batch_us = SecondsSince(start) * 1e6 / queries.size();
+    delete locator;
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int max_n = (argc > 1) ? atoi(argv[1]) : 20000;
+
+    struct Workload {
+        std::string name;
+        std::vector<geometry::Point> (*generate)(int, std::mt19937*);
+    };
+    std::vector<Workload> workloads = {
+        {"random", bench::Random},
+        // Long edges through the middle of a noisy circle cross a lot of slabs
+        {"circle", [](int n, std::mt19937* rng) { return bench::Circle(n, rng, 1e-3); }}};
+
+    // Disagreements with the slabs, single and batch answers, only count answers at different distances
+    // (ties between equidistant sites are fine)
+    printf("%-8s %8s %-6s %10s %10s %10s %10s %10s\n", "workload", "n", "type", "build_s", "query_us", "batch_us",
+           "mbytes", "disagree");
+    for (const Workload& workload : workloads) {
+        for (int n = 1000; n <= max_n; n *= 4) {
+            std::mt19937 rng(n);
+            std::vector<geometry::Point> points = workload.generate(n, &rng);
+            Model model(points);
+            model.SetVisualize(false);
+            Voronoi voronoi(&model);
+            voronoi.ComputeDiagram(std::launch::deferred).get();
+
+            // Queries are spread over the sites' bounding box and a bit around it
+            std::vector<geometry::Point> queries = bench::Random(100000, &rng);
+            for (geometry::Point& pt : queries) {
+                pt.x = (workload.name == "random") ? pt.x * 1.2 - 100 : pt.x * 2.4 - 1200;
+                pt.y = (workload.name == "random") ? pt.y * 1.2 - 100 : pt.y * 2.4 - 1200;
+            }
+
+            // The walk only gets hints within a batch, alone it is just the trapezoidal map
+            Dcel* dcel = model.GetVoronoiDcel();
+            Result slabs = Run(PointLocator::Create(PointLocator::kSlabs), dcel, queries);
+            Result trap = Run(PointLocator::Create(PointLocator::kTrapezoidalMap), dcel, queries);
+            Result walk = Run(new WalkingLocator(PointLocator::Create(PointLocator::kTrapezoidalMap)), dcel, queries);
+            std::vector<std::pair<const char*, const Result*>> rows = {
+                {"slabs", &slabs}, {"trap", &trap}, {"walk", &walk}};
+            for (const auto& row : rows) {
+                const Result& result = *row.second;
+                int disagree = 0;
+                for (int i = 0; i < static_cast<int>(queries.size()); i++) {
+                    for (int answer : {result.answers[i], result.batch_answers[i]}) {
+                        double d1 = geometry::Dist(queries[i], model.GetPoint(slabs.answers[i]));
+                        double d2 = geometry::Dist(queries[i], model.GetPoint(answer));
+                        if (std::fabs(d1 - d2) > 1e-9 * (1 + d1)) disagree++;
+                    }
+                }
+                printf("%-8s %8d %-6s %10.3f %10.3f %10.3f %10.1f %10d\n", workload.name.c_str(), n, row.first,
+                       result.build_secs, result.query_us, result.batch_us, result.mbytes, disagree);
+            }
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "min_annulus_solver.h"
+#include "predicates.h"
+
+// Times the filtered predicates against plain doubles and counts how often they fall back to exact arithmetic
+// To run: ./predicates_bench [n]
+// The last rows solve noisy circles, the kind of input the solver sees, and report the counters of the whole run
+
+namespace {
+
+// Plain double determinants, the way they were computed before the filter
+double NaiveOrient(geometry::Point a, geometry::Point b, geometry::Point c) {
+    return (a.x - c.x) * (b.y - c.y) - (a.y - c.y) * (b.x - c.x);
+}
+
+double NaiveInCircle(geometry::Point a, geometry::Point b, geometry::Point c, geometry::Point d) {
+    double adx = a.x - d.x, ady = a.y - d.y;
+    double bdx = b.x - d.x, bdy = b.y - d.y;
+    double cdx = c.x - d.x, cdy = c.y - d.y;
+    return (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy) + (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy) +
+           (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+}
+
+int Sign(double x) { return (x > 0) - (x < 0); }
+
+// Points on a line rounded to doubles, so nearly every triple is degenerate
+std::vector<geometry::Point> Line(int n, std::mt19937* rng) {
+    std::uniform_real_distribution<double> t(0, 1);
+    std::vector<geometry::Point> points;
+    for (int i = 0; i < n; i++) {
+        double s = t(*rng);
+        points.push_back({0.1 + 1000 * s, 0.3 + 700 * s, i});
+    }
+    return points;
+}
+
+// Runs both predicates over consecutive tuples, prints timings, fallbacks and sign disagreements
+void Run(const std::string& name, const std::vector<geometry::Point>& pts) {
+    int n = pts.size();
+    double naive_sum = 0, filtered_sum = 0;
+    int orient_diff = 0, incircle_diff = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i + 2 < n; i++) {
+        naive_sum += Sign(NaiveOrient(pts[i], pts[i + 1], pts[i + 2]));
+    }
+    double naive_orient_ns = SecondsSince(start) * 1e9 / (n - 2);
+    geometry::ResetPredicateCounters();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i + 2 < n; i++) {
+        filtered_sum += Sign(geometry::Orient2d(pts[i], pts[i + 1], pts[i + 2]));
+    }
+    double orient_ns = SecondsSince(start) * 1e9 / (n - 2);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i + 3 < n; i++) {
+        naive_sum += Sign(NaiveInCircle(pts[i], pts[i + 1], pts[i + 2], pts[i + 3]));
+    }
+    double naive_incircle_ns = SecondsSince(start) * 1e9 / (n - 3);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i + 3 < n; i++) {
+        filtered_sum += Sign(geometry::InCircle(pts[i], pts[i + 1], pts[i + 2], pts[i + 3]));
+    }
+    double incircle_ns = SecondsSince(start) * 1e9 / (n - 3);
+    geometry::PredicateCounters counters = geometry::GetPredicateCounters();
+
+    for (int i = 0; i + 3 < n; i++) {
+        orient_diff += Sign(NaiveOrient(pts[i], pts[i + 1], pts[i + 2])) !=
+                       Sign(geometry::Orient2d(pts[i], pts[i + 1], pts[i + 2]));
+        incircle_diff += Sign(NaiveInCircle(pts[i], pts[i + 1], pts[i + 2], pts[i + 3])) !=
+                         Sign(geometry::InCircle(pts[i], pts[i + 1], pts[i + 2], pts[i + 3]));
+    }
+    printf("%-10s %-9s %10.2f %10.2f %10.4f %10d\n", name.c_str(), "orient", naive_orient_ns, orient_ns,
+           static_cast<double>(counters.orient_exact) / counters.orient_calls, orient_diff);
+    printf("%-10s %-9s %10.2f %10.2f %10.4f %10d\n", name.c_str(), "incircle", naive_incircle_ns, incircle_ns,
+           static_cast<double>(counters.incircle_exact) / counters.incircle_calls, incircle_diff);
+
+    // Keeps the loops from being optimized away
+    if (naive_sum == 0.5 || filtered_sum == 0.5) printf("\n");
+    fflush(stdout);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 1000000;
+    std::mt19937 rng(n);
+
+    // Sign disagreements are cases where plain doubles got the sign wrong
+    printf("%-10s %-9s %10s %10s %10s %10s\n", "input", "predicate", "naive_ns", "filter_ns", "exact_frac", "wrong");
+    Run("random", bench::Random(n, &rng));
+    Run("line", Line(n, &rng));
+    Run("circle", bench::Circle(n, &rng, 0));
+    Run("noisy", bench::Circle(n, &rng, 1e-6));
+
+    // The counters of whole solves
+    printf("\n%-10s %8s %12s %10s %10s\n", "solve", "n", "orient", "exact", "secs");
+    for (double noise : {1e-3, 1e-6, 1e-9}) {
+        for (int sites : {1000, 10000}) {
+            std::vector<geometry::Point> points = bench::Circle(sites, &rng, noise);
+            MinAnnulusSolver solver(0, 1);
+            geometry::ResetPredicateCounters();
+            auto start = std::chrono::steady_clock::now();
+            solver.Solve(points);
+            double secs = SecondsSince(start);
+            geometry::PredicateCounters counters = geometry::GetPredicateCounters();
+            printf("noise=%-4g %8d %12lld %10lld %10.3f\n", noise, sites, counters.orient_calls, counters.orient_exact,
+                   secs);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "bench_util.h"
+#include "exchange_solver.h"
+#include "incremental_solver.h"
+#include "min_annulus_solver.h"
+
+// Times solving the same ring measured again and again with a small drift, starting from the last solution
+// against starting over with the exchange engine
+// To run: ./remeasure_bench [n] [frames]
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 50000;
+    int frames = (argc > 2) ? atoi(argv[2]) : 50;
+
+    // A ring with three lobes, every point drifts by up to 'drift' per frame
+    std::mt19937 rng(n);
+    std::vector<geometry::Point> base = bench::Ring(n, &rng);
+
+    printf("%10s %8s %10s %10s %10s\n", "drift", "warm", "same", "warm_ms", "cold_ms");
+    for (double drift : {0.0, 1e-7, 1e-5, 1e-3}) {
+        std::uniform_real_distribution<double> step(-drift, drift);
+        std::vector<geometry::Point> points = base;
+        IncrementalSolver incremental(MinAnnulusSolver(0, 0, MinAnnulusSolver::kExchange));
+        incremental.Solve(points);
+
+        int same = 0;
+        double warm_secs = 0, cold_secs = 0;
+        for (int f = 0; f < frames; f++) {
+            for (geometry::Point& pt : points) {
+                pt.x += step(rng);
+                pt.y += step(rng);
+            }
+            auto start = std::chrono::steady_clock::now();
+            geometry::Annulus ann = incremental.Remeasure(points);
+            warm_secs += SecondsSince(start);
+
+            start = std::chrono::steady_clock::now();
+            ExchangeSolver exchange(points);
+            geometry::Annulus ref;
+            bool ok = exchange.Solve(&ref);
+            cold_secs += SecondsSince(start);
+            same += ok && ann.center.x == ref.center.x && ann.center.y == ref.center.y &&
+                    ann.r_inner == ref.r_inner && ann.r_outer == ref.r_outer;
+        }
+        printf("%10g %8d %10d %10.3f %10.3f\n", drift, incremental.GetWarmStartCount(), same,
+               warm_secs * 1e3 / frames, cold_secs * 1e3 / frames);
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "bench_util.h"
+#include "width_evaluator.h"
+
+// Times the enclosing annulus scan over many points with every instruction set the CPU has
+// To run: ./width_bench [n]
+// The 'dist' row is the plain loop over geometry::Dist, one sqrt per point
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 1000000;
+    const int kReps = 20;
+    const int kBlock = 64;
+
+    std::mt19937 rng(n);
+    std::vector<geometry::Point> points = bench::Random(n, &rng);
+    std::vector<geometry::Point> centers = bench::Random(kBlock, &rng);
+    WidthEvaluator evaluator(points);
+
+    // The reference, as the candidates measure it
+    std::vector<double> ref_min(kBlock), ref_max(kBlock);
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < kReps; rep++) {
+        geometry::Point center = centers[rep % kBlock];
+        double lo = geometry::Dist(center, points[0]), hi = lo;
+        for (const geometry::Point& pt : points) {
+            double d = geometry::Dist(center, pt);
+            lo = std::min(lo, d);
+            hi = std::max(hi, d);
+        }
+        ref_min[rep % kBlock] = lo;
+        ref_max[rep % kBlock] = hi;
+    }
+    double dist_secs = SecondsSince(start) / kReps;
+
+    // One center at a time streams all points every time, a block streams them once per tile
+    // Bandwidth counts the x and y of every point once per scan
+    printf("%-8s %12s %10s %14s %10s\n", "isa", "scan_ms", "GB/s", "block_ms/ctr", "mismatch");
+    printf("%-8s %12.3f %10.2f %14s %10s\n", "dist", dist_secs * 1e3, 16.0 * n / dist_secs / 1e9, "-", "-");
+    const char* names[] = {"scalar", "sse2", "avx"};
+    for (int isa = WidthEvaluator::kScalar; isa <= WidthEvaluator::BestIsa(); isa++) {
+        evaluator.SetIsa(static_cast<WidthEvaluator::Isa>(isa));
+        int mismatch = 0;
+        start = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < kReps; rep++) {
+            double min_sq, max_sq;
+            evaluator.MinMaxSquaredDist(centers[rep % kBlock], &min_sq, &max_sq);
+            mismatch += (std::sqrt(min_sq) != ref_min[rep % kBlock] || std::sqrt(max_sq) != ref_max[rep % kBlock]);
+        }
+        double scan_secs = SecondsSince(start) / kReps;
+
+        std::vector<double> min_sq(kBlock), max_sq(kBlock);
+        start = std::chrono::steady_clock::now();
+        evaluator.MinMaxSquaredDist(centers.data(), kBlock, min_sq.data(), max_sq.data());
+        double block_secs = SecondsSince(start) / kBlock;
+        for (int i = 0; i < std::min(kBlock, kReps); i++) {
+            mismatch += (std::sqrt(min_sq[i]) != ref_min[i] || std::sqrt(max_sq[i]) != ref_max[i]);
+        }
+        printf("%-8s %12.3f %10.2f %14.3f %10d\n", names[isa], scan_secs * 1e3, 16.0 * n / scan_secs / 1e9,
+               block_secs * 1e3, mismatch);
+    }
+    return 0;
+}
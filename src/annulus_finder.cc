@@ -2,16 +2,29 @@
 
 #include "dcel.h"
 #include "geometry.h"
+#include "thread_pool.h"
+#include "walking_locator.h"
+#include "width_evaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 AnnulusFinder::AnnulusFinder(std::future<void>* fut1, std::future<void>* fut2, Model* model) {
     this->fut1 = fut1;
     this->fut2 = fut2;
     this->model = model;
+    voronoi_pl = fp_voronoi_pl = nullptr;
+}
+
+AnnulusFinder::~AnnulusFinder() {
+    delete voronoi_pl;
+    delete fp_voronoi_pl;
 }
 
-std::future<void> AnnulusFinder::FindAnnulus() {
+std::future<void> AnnulusFinder::FindAnnulus(std::launch policy) {
     // Launch a new thread
-    return std::async(std::launch::async, &AnnulusFinder::MergeAndFind, this);
+    return std::async(policy, &AnnulusFinder::MergeAndFind, this);
 }
 
 void AnnulusFinder::MergeAndFind() {
@@ -20,104 +33,502 @@ void AnnulusFinder::MergeAndFind() {
     fut2->get();
 
     // Initialize locators
-    voronoi_pl.LoadDcel(model->GetVoronoiDcel());
-    fp_voronoi_pl.LoadDcel(model->GetFpVoronoiDcel());
+    StageTimes* times = model->GetStageTimes();
+    auto start = std::chrono::steady_clock::now();
+    delete voronoi_pl;
+    delete fp_voronoi_pl;
+    voronoi_pl = PointLocator::Create(model->GetPointLocatorType(), model->GetNumThreads());
+    fp_voronoi_pl = PointLocator::Create(model->GetPointLocatorType(), model->GetNumThreads());
+    if (model->GetWalkingPointLocation()) {
+        voronoi_pl = new WalkingLocator(voronoi_pl);
+        fp_voronoi_pl = new WalkingLocator(fp_voronoi_pl);
+    }
+    voronoi_pl->LoadDcel(model->GetVoronoiDcel());
+    fp_voronoi_pl->LoadDcel(model->GetFpVoronoiDcel());
+    times->locators = SecondsSince(start);
 
-    // Find the best candidate
+    // Find the best candidate, cross-checked against all points
     GenerateCandidates();
+    start = std::chrono::steady_clock::now();
+    model->VerifyAnnCandidates(WidthEvaluator(model->GetPoints()));
     model->FindBestAnnulus();
-    printf("Annulus Finder done!\n");
-    double roundness = model->GetAnnulus()->r_outer - model->GetAnnulus()->r_inner;
-    printf("Roundness = %.2f\n", roundness < 1e-6 ? 0 : roundness);
+    times->reduction += SecondsSince(start);
+    if (model->GetVisualize()) {
+        printf("Annulus Finder done!\n");
+        double roundness = model->GetAnnulus()->r_outer - model->GetAnnulus()->r_inner;
+        printf("Roundness = %.2f\n", roundness < 1e-6 ? 0 : roundness);
+    }
 }
 
 void AnnulusFinder::GenerateCandidates() {
+    StageTimes* times = model->GetStageTimes();
+    auto start = std::chrono::steady_clock::now();
+    ThreadPool pool(model->GetNumThreads());
+    std::vector<EdgePiece> pieces1 = CollectPieces(model->GetVoronoiDcel());
+    std::vector<EdgePiece> pieces2 = CollectPieces(model->GetFpVoronoiDcel());
+
+    // Vertices of each diagram are located in the other one in a single batch
+    std::vector<int> farthest = LocateVertices(model->GetVoronoiDcel(), fp_voronoi_pl, &pool);
+    std::vector<int> closest = LocateVertices(model->GetFpVoronoiDcel(), voronoi_pl, &pool);
+    CrossingPairs pairs = FindCrossingPairs(pieces1, pieces2, closest, &pool);
+
+    // Split every candidate type into chunks, a few per thread so that uneven chunks even out
+    struct Chunk {
+        int type;
+        int begin, end;
+    };
+    std::vector<Chunk> chunks;
+    auto split = [&chunks, &pool](int type, int sz) {
+        int chunk_sz = std::max(1, sz / (8 * pool.GetNumThreads()));
+        for (int begin = 0; begin < sz; begin += chunk_sz) {
+            chunks.push_back({type, begin, std::min(sz, begin + chunk_sz)});
+        }
+    };
+    split(1, model->GetVoronoiDcel()->vertices.size());
+    split(2, model->GetFpVoronoiDcel()->vertices.size());
+    split(3, pieces1.size());
+    times->overlay = SecondsSince(start);
+
+    // Every chunk reduces its own candidates
+    std::vector<CandidateReducer> reducers(chunks.size(),
+                                           CandidateReducer(model->GetTopK(), model->GetKeepCandidates()));
+    std::vector<double> chunk_secs(chunks.size());
+    pool.Run(chunks.size(), [&](int idx, int) {
+        auto chunk_start = std::chrono::steady_clock::now();
+        const Chunk& chunk = chunks[idx];
+        CandidateReducer* out = &reducers[idx];
+        if (chunk.type == 1) {
+            VoronoiVertexCandidates(farthest, chunk.begin, chunk.end, out);
+        } else if (chunk.type == 2) {
+            FpVoronoiVertexCandidates(closest, chunk.begin, chunk.end, out);
+        } else {
+            IntersectionCandidates(pieces1, pieces2, pairs, chunk.begin, chunk.end, out);
+        }
+        chunk_secs[idx] = SecondsSince(chunk_start);
+    });
+    for (int idx = 0; idx < static_cast<int>(chunks.size()); idx++) {
+        times->candidates[chunks[idx].type - 1] += chunk_secs[idx];
+    }
+
+    // Chunks are merged in order, so the candidates come in the same order for any number of threads
+    // and ties between equally good candidates are broken the same way
+    start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(*(model->GetMutex()));
+    for (const CandidateReducer& reducer : reducers) {
+        model->MergeAnnCandidates(reducer);
+    }
+    times->reduction = SecondsSince(start);
+}
+
+std::vector<int> AnnulusFinder::LocateVertices(Dcel* dcel, PointLocator* locator, ThreadPool* pool) {
+    std::vector<geometry::Point> pts;
+    for (const Dcel::Vertex& v : dcel->vertices) {
+        pts.push_back(v.point);
+    }
+    std::vector<int> faces(pts.size());
+    locator->LocateBatch(pts.data(), pts.size(), faces.data(), pool);
+    return faces;
+}
+
+void AnnulusFinder::VoronoiVertexCandidates(const std::vector<int>& farthest, int begin, int end,
+                                            CandidateReducer* out) {
     // Candidate type 1: Voronoi vertices
-    for (Dcel::Vertex* vert : model->GetVoronoiDcel()->vertices) {
+    Dcel* voronoi_dcel = model->GetVoronoiDcel();
+    for (int v = begin; v < end; v++) {
         // Ignore box vertices
-        if (vert->box) continue;
+        const Dcel::Vertex& vert = voronoi_dcel->vertices[v];
+        if (vert.box) continue;
 
         // We need any half-edge since the distances are the same
-        Dcel::HalfEdge* he = vert->incident_halfedge;
-        int idx = he->incident_face->site;
+        int idx = voronoi_dcel->Site(vert.incident_halfedge);
 
         // Build the annulus
         geometry::Annulus ann;
-        ann.center = vert->point;
+        ann.center = vert.point;
         ann.r_inner = geometry::Dist(ann.center, model->GetPoint(idx));
-        geometry::Point farthest = model->GetHullPoint(fp_voronoi_pl.Locate(ann.center));
-        ann.r_outer = geometry::Dist(ann.center, farthest);
-        {
-            std::lock_guard<std::mutex> lock(*(model->GetMutex()));
-            model->AddAnnCandidate(ann);
-        }
+        ann.r_outer = geometry::Dist(ann.center, model->GetHullPoint(farthest[v]));
+        out->Add(ann);
     }
+}
 
+void AnnulusFinder::FpVoronoiVertexCandidates(const std::vector<int>& closest, int begin, int end,
+                                              CandidateReducer* out) {
     // Candidate type 2: farthest-point Voronoi vertices
-    for (Dcel::Vertex* vert : model->GetFpVoronoiDcel()->vertices) {
+    Dcel* fp_voronoi_dcel = model->GetFpVoronoiDcel();
+    for (int v = begin; v < end; v++) {
         // Ignore box vertices
-        if (vert->box) continue;
+        const Dcel::Vertex& vert = fp_voronoi_dcel->vertices[v];
+        if (vert.box) continue;
 
         // We need any half-edge since the distances are the same
-        Dcel::HalfEdge* he = vert->incident_halfedge;
-        int idx = he->incident_face->site;
+        int idx = fp_voronoi_dcel->Site(vert.incident_halfedge);
 
         // Build the annulus
         geometry::Annulus ann;
-        ann.center = vert->point;
+        ann.center = vert.point;
         ann.r_outer = geometry::Dist(ann.center, model->GetHullPoint(idx));
-        geometry::Point closest = model->GetPoint(voronoi_pl.Locate(ann.center));
-        ann.r_inner = geometry::Dist(ann.center, closest);
-        {
-            std::lock_guard<std::mutex> lock(*(model->GetMutex()));
-            model->AddAnnCandidate(ann);
-        }
+        ann.r_inner = geometry::Dist(ann.center, model->GetPoint(closest[v]));
+        out->Add(ann);
     }
+}
 
+void AnnulusFinder::IntersectionCandidates(const std::vector<EdgePiece>& pieces1,
+                                           const std::vector<EdgePiece>& pieces2, const CrossingPairs& pairs,
+                                           int begin, int end, CandidateReducer* out) {
     // Candidate type 3: Edge intersections
-    for (Dcel::HalfEdge* he1 : model->GetVoronoiDcel()->half_edges) {
-        // Ignore box edges and duplicates
-        if (he1->incident_face < he1->twin->incident_face) continue;
-        if (he1->origin->box && he1->twin->origin->box) continue;
-
-        for (Dcel::HalfEdge* he2 : model->GetFpVoronoiDcel()->half_edges) {
-            // Ignore box edges and duplicates
-            if (he2->incident_face < he2->twin->incident_face) continue;
-            if (he2->origin->box && he2->twin->origin->box) continue;
-
-            // Orient halflines properly
-            if (he1->origin->box) he1 = he1->twin;
-            if (he2->origin->box) he2 = he2->twin;
-
-            // Process 4 cases (halfline/segment X halfline/segment)
-            if (geometry::ParallelLines(he1->line, he2->line)) continue;
-            geometry::Point inter = geometry::LineIntersection(he1->line, he2->line);
-            bool has_intersection = true;
-            if (he1->twin->origin->box) {
-                // Halfline
-                has_intersection &= geometry::CheckHalflineSide(inter, he1->line, he1->origin->point);
-            } else {
-                // Segment
-                has_intersection &= geometry::CheckOrder(he1->origin->point, inter, he1->twin->origin->point);
-            }
-            if (he2->twin->origin->box) {
-                // Halfline
-                has_intersection &= geometry::CheckHalflineSide(inter, he2->line, he2->origin->point);
-            } else {
-                // Segment
-                has_intersection &= geometry::CheckOrder(he2->origin->point, inter, he2->twin->origin->point);
-            }
-            if (!has_intersection) continue;
+    // Only pairs that can meet are tested, in the same order as a test of all pairs would
+    Dcel* voronoi_dcel = model->GetVoronoiDcel();
+    Dcel* fp_voronoi_dcel = model->GetFpVoronoiDcel();
+    std::vector<int> row;
+    for (int i = begin; i < end; i++) {
+        pairs.GetRow(i, &row);
+        for (int j : row) {
+            const EdgePiece& piece1 = pieces1[i];
+            const EdgePiece& piece2 = pieces2[j];
+            geometry::Point inter;
+            if (!Intersect(piece1, piece2, 0, &inter)) continue;
 
             // Build the annulus
             geometry::Annulus ann;
             ann.center = inter;
-            ann.r_inner = geometry::Dist(ann.center, model->GetPoint(he1->incident_face->site));
-            ann.r_outer = geometry::Dist(ann.center, model->GetHullPoint(he2->incident_face->site));
-            {
-                std::lock_guard<std::mutex> lock(*(model->GetMutex()));
-                model->AddAnnCandidate(ann);
+            ann.r_inner = geometry::Dist(ann.center, model->GetPoint(voronoi_dcel->Site(piece1.he)));
+            ann.r_outer = geometry::Dist(ann.center, model->GetHullPoint(fp_voronoi_dcel->Site(piece2.he)));
+            out->Add(ann);
+        }
+    }
+}
+
+void AnnulusFinder::CrossingPairs::GetRow(int i, std::vector<int>* row) const {
+    // Each pair once, sorted
+    row->clear();
+    if (with_all[i]) {
+        for (int j = 0; j < num_pieces2; j++) {
+            row->push_back(j);
+        }
+    } else {
+        row->assign(walked.begin() + row_start[i], walked.begin() + row_start[i + 1]);
+    }
+    row->erase(std::unique(row->begin(), row->end()), row->end());
+}
+
+std::vector<AnnulusFinder::EdgePiece> AnnulusFinder::CollectPieces(Dcel* dcel) {
+    std::vector<EdgePiece> pieces;
+    int he_sz = dcel->half_edges.size();
+    for (int idx = 0; idx < he_sz; idx++) {
+        // Ignore box edges and duplicates
+        int he = idx;
+        if (dcel->Site(he) < dcel->Site(dcel->Twin(he))) continue;
+        if (dcel->OriginOnBox(he) && dcel->OriginOnBox(dcel->Twin(he))) continue;
+
+        // Orient halflines properly
+        if (dcel->OriginOnBox(he)) he = dcel->Twin(he);
+        EdgePiece piece;
+        piece.idx = idx;
+        piece.he = he;
+        piece.line = dcel->half_edges[he].line;
+        piece.orig = dcel->OriginPoint(he);
+        piece.dest = dcel->OriginPoint(dcel->Twin(he));
+        piece.halfline = dcel->OriginOnBox(dcel->Twin(he));
+        pieces.push_back(piece);
+    }
+    return pieces;
+}
+
+bool AnnulusFinder::Intersect(const EdgePiece& a, const EdgePiece& b, double tol, geometry::Point* inter) {
+    // Process 4 cases (halfline/segment X halfline/segment)
+    if (geometry::ParallelLines(a.line, b.line)) return false;
+    *inter = geometry::LineIntersection(a.line, b.line);
+    bool on_a = OnPiece(a, *inter, tol);
+    bool on_b = OnPiece(b, *inter, tol);
+    return on_a && on_b;
+}
+
+bool AnnulusFinder::OnPiece(const EdgePiece& piece, geometry::Point pt, double tol) {
+    if (tol == 0) {
+        if (piece.halfline) return geometry::CheckHalflineSide(pt, piece.line, piece.orig);
+        return geometry::CheckOrder(piece.orig, pt, piece.dest);
+    }
+
+    // Relaxed version of the same checks
+    if (piece.halfline) {
+        switch (piece.line.dir) {
+            case 'u':
+                return pt.y >= piece.orig.y - tol;
+            case 'd':
+                return pt.y <= piece.orig.y + tol;
+            case 'l':
+                return pt.x <= piece.orig.x + tol;
+            case 'r':
+                return pt.x >= piece.orig.x - tol;
+        }
+        return true;
+    }
+    bool x = pt.x >= std::min(piece.orig.x, piece.dest.x) - tol && pt.x <= std::max(piece.orig.x, piece.dest.x) + tol;
+    bool y = pt.y >= std::min(piece.orig.y, piece.dest.y) - tol && pt.y <= std::max(piece.orig.y, piece.dest.y) + tol;
+    return x && y;
+}
+
+bool AnnulusFinder::PointInRect(const EdgePiece& piece, geometry::Rect rect, double tol, geometry::Point* pt) {
+    // Vertices are not always exactly on the line, so the point is picked on the line, among the points
+    // that pass the relaxed checks. Points on the line are given by x, or by y if the line is vertical
+    const geometry::Line& line = piece.line;
+    const double inf = std::numeric_limits<double>::infinity();
+    double lo = -inf, hi = inf;
+    bool empty = false;
+    auto clip_x = [&](double x1, double x2) {
+        if (line.vertical) {
+            empty |= line.x < x1 || line.x > x2;
+        } else {
+            lo = std::max(lo, x1);
+            hi = std::min(hi, x2);
+        }
+    };
+    auto clip_y = [&](double y1, double y2) {
+        if (line.vertical) {
+            lo = std::max(lo, y1);
+            hi = std::min(hi, y2);
+        } else if (line.k == 0) {
+            empty |= line.n < y1 || line.n > y2;
+        } else {
+            double xa = (y1 - line.n) / line.k, xb = (y2 - line.n) / line.k;
+            lo = std::max(lo, std::min(xa, xb));
+            hi = std::min(hi, std::max(xa, xb));
+        }
+    };
+
+    if (piece.halfline) {
+        switch (line.dir) {
+            case 'u':
+                clip_y(piece.orig.y - tol, inf);
+                break;
+            case 'd':
+                clip_y(-inf, piece.orig.y + tol);
+                break;
+            case 'l':
+                clip_x(-inf, piece.orig.x + tol);
+                break;
+            case 'r':
+                clip_x(piece.orig.x - tol, inf);
+                break;
+        }
+    } else {
+        clip_x(std::min(piece.orig.x, piece.dest.x) - tol, std::max(piece.orig.x, piece.dest.x) + tol);
+        clip_y(std::min(piece.orig.y, piece.dest.y) - tol, std::max(piece.orig.y, piece.dest.y) + tol);
+    }
+    clip_x(rect.x1, rect.x2);
+    clip_y(rect.y1, rect.y2);
+    if (empty || lo > hi) return false;
+
+    double t = (lo + hi) / 2;
+    *pt = line.vertical ? geometry::Point({line.x, t, 0}) : geometry::Point({t, line.k * t + line.n, 0});
+    return true;
+}
+
+AnnulusFinder::CrossingPairs AnnulusFinder::FindCrossingPairs(const std::vector<EdgePiece>& pieces1,
+                                                              const std::vector<EdgePiece>& pieces2,
+                                                              const std::vector<int>& closest, ThreadPool* pool) {
+    Dcel* dcel = model->GetVoronoiDcel();
+    Dcel* fp_dcel = model->GetFpVoronoiDcel();
+    int num_sites = model->GetNumSites();
+    int he_sz = dcel->half_edges.size();
+
+    // Pieces by the half-edge they were found at
+    std::vector<int> piece_at(he_sz, -1);
+    int sz1 = pieces1.size();
+    for (int i = 0; i < sz1; i++) {
+        piece_at[pieces1[i].idx] = i;
+    }
+
+    // Half-edges around each Voronoi cell, box edges excluded since cells go on past the box
+    std::vector<int> cell_start(num_sites + 1, 0);
+    for (int he = 0; he < he_sz; he++) {
+        int face = dcel->half_edges[he].incident_face;
+        int twin_face = dcel->half_edges[dcel->Twin(he)].incident_face;
+        if (face < num_sites && twin_face < num_sites) cell_start[face + 1]++;
+    }
+    for (int f = 0; f < num_sites; f++) {
+        cell_start[f + 1] += cell_start[f];
+    }
+    std::vector<int> cell_edges(cell_start[num_sites]);
+    std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+    for (int he = 0; he < he_sz; he++) {
+        int face = dcel->half_edges[he].incident_face;
+        int twin_face = dcel->half_edges[dcel->Twin(he)].incident_face;
+        if (face < num_sites && twin_face < num_sites) cell_edges[fill[face]++] = he;
+    }
+
+    // Relaxation for the walk, generous compared to rounding errors
+    double scale = 1;
+    for (const Dcel::Vertex& v : dcel->vertices) {
+        scale = std::max(scale, std::max(std::fabs(v.point.x), std::fabs(v.point.y)));
+    }
+    for (const Dcel::Vertex& v : fp_dcel->vertices) {
+        scale = std::max(scale, std::max(std::fabs(v.point.x), std::fabs(v.point.y)));
+    }
+    double tol = 1e-9 * scale;
+
+    // Far from the sites cells get thin and the walk can lose its way, so every piece is walked from a point
+    // in a rect around the sites and from its own vertices
+    geometry::Rect rect = {model->GetPoint(0).x, model->GetPoint(0).x, model->GetPoint(0).y, model->GetPoint(0).y};
+    for (int i = 1; i < num_sites; i++) {
+        rect.x1 = std::min(rect.x1, model->GetPoint(i).x);
+        rect.x2 = std::max(rect.x2, model->GetPoint(i).x);
+        rect.y1 = std::min(rect.y1, model->GetPoint(i).y);
+        rect.y2 = std::max(rect.y2, model->GetPoint(i).y);
+    }
+    double margin = std::max(1.0, std::max(rect.x2 - rect.x1, rect.y2 - rect.y1));
+    rect = {rect.x1 - margin, rect.x2 + margin, rect.y1 - margin, rect.y2 + margin};
+
+    // The walk follows the real cells, so a halfline can only be found by it if it's oriented outwards,
+    // away from the sites, like the real unbounded edge. Others (nearly vertical lines can end up
+    // flipped) are tested against all farthest-point pieces
+    geometry::Point centroid = {0, 0, 0};
+    for (int i = 0; i < num_sites; i++) {
+        centroid.x += model->GetPoint(i).x / num_sites;
+        centroid.y += model->GetPoint(i).y / num_sites;
+    }
+    int sz2 = pieces2.size();
+    CrossingPairs pairs;
+    pairs.num_pieces2 = sz2;
+    pairs.with_all.assign(sz1, false);
+    for (int i = 0; i < sz1; i++) {
+        const EdgePiece& piece = pieces1[i];
+        if (!piece.halfline) continue;
+        geometry::Point a = model->GetPoint(dcel->Site(piece.he));
+        geometry::Point b = model->GetPoint(dcel->Site(dcel->Twin(piece.he)));
+
+        // Direction of the halfline as the checks see it
+        double dx, dy;
+        const geometry::Line& line = piece.line;
+        if (line.vertical) {
+            dx = 0, dy = (line.dir == 'u') ? 1 : -1;
+        } else if (line.dir == 'r' || line.dir == 'l') {
+            dx = (line.dir == 'r') ? 1 : -1, dy = dx * line.k;
+        } else {
+            dx = dy = 0;  // Unclear, test with all
+        }
+
+        // The outward normal of ab points away from the centroid
+        double ab_x = b.x - a.x, ab_y = b.y - a.y;
+        double side = ab_x * (centroid.y - a.y) - ab_y * (centroid.x - a.x);
+        double out = side * (dx * ab_y - dy * ab_x);
+        double len = std::sqrt(ab_x * ab_x + ab_y * ab_y) * std::sqrt(dx * dx + dy * dy);
+        if (std::fabs(side) <= 1e-9 * scale * len || out <= 0.5 * std::fabs(side) * len) {
+            pairs.with_all[i] = true;
+        }
+    }
+
+    // Walks the pieces in [begin, end), collecting the pairs it meets
+    auto walk = [&](int begin, int end, std::vector<int>* visited, std::vector<int>* queue,
+                    std::vector<std::pair<int, int>>* found) {
+        for (int j = begin; j < end; j++) {
+            const EdgePiece& piece2 = pieces2[j];
+
+            // Start at the cells holding the vertices of the piece, located already, and at a point in the rect.
+            // The locator is only a hint near edges, walking to a closer neighbour always ends at the nearest site
+            geometry::Point starts[3];
+            int hints[3];
+            int num_starts = 0;
+            int ends[2] = {fp_dcel->half_edges[piece2.he].origin, fp_dcel->half_edges[fp_dcel->Twin(piece2.he)].origin};
+            for (int v : ends) {
+                if (fp_dcel->vertices[v].box) continue;
+                starts[num_starts] = fp_dcel->vertices[v].point;
+                hints[num_starts++] = closest[v];
+            }
+            if (PointInRect(piece2, rect, tol, &starts[num_starts])) {
+                hints[num_starts] = voronoi_pl->Locate(starts[num_starts]);
+                num_starts++;
+            }
+            queue->clear();
+            for (int s = 0; s < num_starts; s++) {
+                geometry::Point start = starts[s];
+                int cell = hints[s];
+                while (true) {
+                    int next = cell;
+                    double next_dist = geometry::Dist(model->GetPoint(cell), start);
+                    for (int k = cell_start[cell]; k < cell_start[cell + 1]; k++) {
+                        int other = dcel->Site(dcel->Twin(cell_edges[k]));
+                        double dist = geometry::Dist(model->GetPoint(other), start);
+                        if (dist < next_dist) {
+                            next = other;
+                            next_dist = dist;
+                        }
+                    }
+                    if (next == cell) break;
+                    cell = next;
+                }
+                if ((*visited)[cell] == j) continue;
+                queue->push_back(cell);
+                (*visited)[cell] = j;
             }
+
+            // Visit the cells along the piece, every edge of a visited cell is a candidate
+            for (int q = 0; q < static_cast<int>(queue->size()); q++) {
+                int curr = (*queue)[q];
+                for (int k = cell_start[curr]; k < cell_start[curr + 1]; k++) {
+                    int he = cell_edges[k];
+                    int twin = dcel->Twin(he);
+                    if (piece_at[he] != -1) found->push_back({piece_at[he], j});
+                    if (piece_at[twin] != -1) found->push_back({piece_at[twin], j});
+
+                    // Cross into the next cell if the piece (nearly) crosses this edge
+                    int next = dcel->Site(twin);
+                    if ((*visited)[next] == j) continue;
+                    int piece1 = (piece_at[he] != -1) ? piece_at[he] : piece_at[twin];
+                    geometry::Point inter;
+                    bool crosses;
+                    if (piece1 != -1 && !pieces1[piece1].halfline) {
+                        crosses = Intersect(pieces1[piece1], piece2, tol, &inter);
+                    } else {
+                        // Halflines and infinite lines (e.g. between collinear sites) are crossed as whole lines,
+                        // the real edge is a part of the line even if the halfline points the wrong way
+                        const geometry::Line& line = dcel->half_edges[he].line;
+                        crosses = !geometry::ParallelLines(line, piece2.line) &&
+                                  OnPiece(piece2, geometry::LineIntersection(line, piece2.line), tol);
+                    }
+                    if (crosses) {
+                        (*visited)[next] = j;
+                        queue->push_back(next);
+                    }
+                }
+            }
+        }
+    };
+
+    // Pieces are walked in parallel chunks, with the scratch space shared by the chunks of a thread
+    int num_threads = pool->GetNumThreads();
+    int chunk_sz = std::max(1, sz2 / (8 * num_threads));
+    int num_chunks = (sz2 + chunk_sz - 1) / chunk_sz;
+    std::vector<std::vector<std::pair<int, int>>> found(num_chunks);
+    std::vector<std::vector<int>> visited(num_threads), queue(num_threads);
+    pool->Run(num_chunks, [&](int chunk, int thread) {
+        visited[thread].resize(num_sites, -1);
+        walk(chunk * chunk_sz, std::min(sz2, (chunk + 1) * chunk_sz), &visited[thread], &queue[thread],
+             &found[chunk]);
+    });
+
+    // Group the pairs by the Voronoi piece
+    pairs.row_start.assign(sz1 + 1, 0);
+    for (const std::vector<std::pair<int, int>>& chunk : found) {
+        for (const std::pair<int, int>& pair : chunk) {
+            pairs.row_start[pair.first + 1]++;
         }
     }
+    for (int i = 0; i < sz1; i++) {
+        pairs.row_start[i + 1] += pairs.row_start[i];
+    }
+    pairs.walked.resize(pairs.row_start[sz1]);
+    fill.assign(pairs.row_start.begin(), pairs.row_start.end() - 1);
+    for (const std::vector<std::pair<int, int>>& chunk : found) {
+        for (const std::pair<int, int>& pair : chunk) {
+            pairs.walked[fill[pair.first]++] = pair.second;
+        }
+    }
+    int rows_per_chunk = std::max(1, sz1 / (8 * num_threads));
+    pool->Run((sz1 + rows_per_chunk - 1) / rows_per_chunk, [&pairs, rows_per_chunk, sz1](int chunk, int) {
+        for (int i = chunk * rows_per_chunk; i < std::min(sz1, (chunk + 1) * rows_per_chunk); i++) {
+            std::sort(pairs.walked.begin() + pairs.row_start[i], pairs.walked.begin() + pairs.row_start[i + 1]);
+        }
+    });
+    return pairs;
 }
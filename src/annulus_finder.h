@@ -1,28 +1,80 @@
 #pragma once
 #include <future>
+#include <utility>
+#include <vector>
+#include "candidate_reducer.h"
 #include "model.h"
 #include "point_locator.h"
+#include "thread_pool.h"
 
 class AnnulusFinder {
    public:
     AnnulusFinder(std::future<void>* fut1, std::future<void>* fut2, Model* model);
+    ~AnnulusFinder();
 
-    // Finds the winning annulus in a new thread
-    std::future<void> FindAnnulus();
+    // Finds the winning annulus in a new thread (or lazily, on get(), if deferred)
+    std::future<void> FindAnnulus(std::launch policy = std::launch::async);
 
    private:
     // Merges farthest-point Voronoi DCEL and Voronoi DCEL and finds the best annulus
     void MergeAndFind();
 
-    // Generates annulus candidates
+    // Generates annulus candidates on a thread pool
     void GenerateCandidates();
 
+    // An edge that can give type 3 candidates, oriented so that 'orig' is not on the box
+    struct EdgePiece {
+        int idx;  // Half-edge the piece was found at
+        int he;   // Oriented half-edge
+        geometry::Line line;
+        geometry::Point orig, dest;
+        bool halfline;  // If set, 'dest' is on the box and the edge is treated as a halfline
+    };
+
+    // Collects the pieces of a diagram, skipping box edges and twins
+    std::vector<EdgePiece> CollectPieces(Dcel* dcel);
+
+    // Intersects two pieces, checks are relaxed by 'tol' on every side
+    bool Intersect(const EdgePiece& a, const EdgePiece& b, double tol, geometry::Point* inter);
+
+    // Checks if a point on the line of a piece falls on the piece
+    bool OnPiece(const EdgePiece& piece, geometry::Point pt, double tol);
+
+    // Finds a point on the line of a piece inside the rect that passes the relaxed checks
+    bool PointInRect(const EdgePiece& piece, geometry::Rect rect, double tol, geometry::Point* pt);
+
+    // All (Voronoi piece, farthest-point piece) pairs that can intersect, grouped by the Voronoi piece
+    struct CrossingPairs {
+        int num_pieces2;
+        std::vector<int> row_start, walked;  // Pairs met by the walk, sorted in each row
+        std::vector<bool> with_all;          // Tested against all farthest-point pieces
+
+        // Farthest-point pieces to test against Voronoi piece 'i', sorted, each once
+        void GetRow(int i, std::vector<int>* row) const;
+    };
+
+    // Walks every farthest-point piece through the Voronoi cells it passes, so only the edges
+    // of these cells are tested. 'closest' are the sites located for the farthest-point vertices
+    CrossingPairs FindCrossingPairs(const std::vector<EdgePiece>& pieces1, const std::vector<EdgePiece>& pieces2,
+                                    const std::vector<int>& closest, ThreadPool* pool);
+
+    // Locates all vertices of a diagram with the locator of the other diagram, box vertices included
+    std::vector<int> LocateVertices(Dcel* dcel, PointLocator* locator, ThreadPool* pool);
+
+    // Candidates of each type, for a range of Voronoi vertices, farthest-point Voronoi vertices
+    // or Voronoi pieces. Vertices come with the sites located for them in the other diagram
+    void VoronoiVertexCandidates(const std::vector<int>& farthest, int begin, int end, CandidateReducer* out);
+    void FpVoronoiVertexCandidates(const std::vector<int>& closest, int begin, int end, CandidateReducer* out);
+    void IntersectionCandidates(const std::vector<EdgePiece>& pieces1, const std::vector<EdgePiece>& pieces2,
+                                const CrossingPairs& pairs, int begin, int end, CandidateReducer* out);
+
     // Futures from Voronoi threads
     std::future<void>* fut1;
     std::future<void>* fut2;
 
-    // Point locators for both diagrams
-    PointLocator voronoi_pl, fp_voronoi_pl;
+    // Point locators for both diagrams, of the type the model asks for
+    PointLocator* voronoi_pl;
+    PointLocator* fp_voronoi_pl;
 
     Model* model;
 };
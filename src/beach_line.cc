@@ -1,17 +1,21 @@
 #include "beach_line.h"
 
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
 TreeNode::TreeNode(bool leaf) {
     this->leaf = leaf;
-    this->id = rand();
+    this->height = 1;
     left = right = parent = nullptr;
 }
 
 LeafNode::LeafNode(int site) : TreeNode(true) {
     this->site = site;
-    this->circle_event = nullptr;
+    this->circle_event = EventQueue::kNone;
 }
 
-InternalNode::InternalNode(std::pair<int, int> sites, Dcel::HalfEdge* half_edge) : TreeNode(false) {
+InternalNode::InternalNode(std::pair<int, int> sites, int half_edge) : TreeNode(false) {
     this->sites = sites;
     this->half_edge = half_edge;
 }
@@ -90,37 +94,17 @@ LeafNode* BeachLine::FindSucc(LeafNode* leaf) {
     return static_cast<LeafNode*>(curr);
 }
 
-void BeachLine::InitialInsert(int site, Dcel::HalfEdge* he) {
-    int leftest_site;
-
-    if (root->IsLeaf()) {
-        leftest_site = static_cast<InternalNode*>(root)->GetSites().first;
-    } else {
-        leftest_site = static_cast<LeafNode*>(root)->GetSite();
-    }
-
-    InternalNode* new_root = new InternalNode({site, leftest_site}, he);
-    LeafNode* leaf = new LeafNode(site);
-    new_root->SetLeft(leaf);
-    leaf->SetParent(new_root);
-    new_root->SetRight(root);
-    root->SetParent(new_root);
-    root = new_root;
+void BeachLine::InitialInsert(int site, int he) {
+    // Initial sites come from right to left, split the leftmost arc
+    LeafNode* first_leaf = GetFirstLeaf();
+    InternalNode* internal = new InternalNode({site, first_leaf->GetSite()}, he);
+    Replace(first_leaf, internal);
+    Link(internal, new LeafNode(site), first_leaf);
+    Rebalance(internal);
 }
 
-LeafNode* BeachLine::Insert(LeafNode* curr, int site, Dcel::HalfEdge* upper, Dcel::HalfEdge* lower) {
+LeafNode* BeachLine::Insert(LeafNode* curr, int site, int upper, int lower) {
     int other = curr->GetSite();
-    TreeNode* parent = curr->GetParent();
-    char side;
-    if (parent != nullptr && parent->GetLeft() == curr) {
-        side = 'l';
-    } else {
-        side = 'r';
-    }
-    if (curr->GetCircleEvent() != nullptr) {
-        curr->GetCircleEvent()->SetArc(nullptr);
-    }
-    delete curr;
 
     // Add 5 new nodes: 3 leaves and 2 internal intersections
     LeafNode* leaf1 = new LeafNode(other);
@@ -128,30 +112,22 @@ LeafNode* BeachLine::Insert(LeafNode* curr, int site, Dcel::HalfEdge* upper, Dce
     LeafNode* leaf3 = new LeafNode(other);
     InternalNode* internal1 = new InternalNode({other, site}, upper);
     InternalNode* internal2 = new InternalNode({site, other}, lower);
-    if (parent == nullptr) {
-        root = internal1;
-    } else {
-        if (side == 'l') {
-            parent->SetLeft(internal1);
-        } else {
-            parent->SetRight(internal1);
-        }
-        internal1->SetParent(parent);
-    }
 
-    // Link nodes
-    internal1->SetLeft(leaf1);
-    leaf1->SetParent(internal1);
-    internal1->SetRight(internal2);
-    internal2->SetParent(internal1);
-    internal2->SetLeft(leaf2);
-    leaf2->SetParent(internal2);
-    internal2->SetRight(leaf3);
-    leaf3->SetParent(internal2);
+    // Split in two steps so that each one grows the tree by one level like a regular AVL insert
+    // First the old arc becomes internal1 -> (leaf1, leaf3)
+    Replace(curr, internal1);
+    Link(internal1, leaf1, leaf3);
+    delete curr;
+    Rebalance(internal1);
+
+    // Then leaf3 becomes internal2 -> (leaf2, leaf3)
+    Replace(leaf3, internal2);
+    Link(internal2, leaf2, leaf3);
+    Rebalance(internal2);
     return leaf2;
 }
 
-std::pair<Dcel::HalfEdge*, Dcel::HalfEdge*> BeachLine::Delete(LeafNode* arc, Dcel::HalfEdge* nw) {
+std::pair<int, int> BeachLine::Delete(LeafNode* arc, int nw) {
     // Find pred/succ
     LeafNode* pred = FindPred(arc);
     LeafNode* succ = FindSucc(arc);
@@ -169,7 +145,7 @@ std::pair<Dcel::HalfEdge*, Dcel::HalfEdge*> BeachLine::Delete(LeafNode* arc, Dce
     InternalNode* other_lca = up;  // LCA 2
 
     // Save half edges that got merged
-    std::pair<Dcel::HalfEdge*, Dcel::HalfEdge*> ret;
+    std::pair<int, int> ret;
     if (side == 'r') {
         ret.first = parent->GetHalfEdge();
         ret.second = other_lca->GetHalfEdge();
@@ -201,17 +177,20 @@ std::pair<Dcel::HalfEdge*, Dcel::HalfEdge*> BeachLine::Delete(LeafNode* arc, Dce
     delete arc;
     delete parent;
 
+    // The subtree got one level shorter
+    Rebalance(grandpa);
+
     // return
     return ret;
 }
 
-void BeachLine::PrintToDot(TreeNode* node, std::ofstream& dot_file) {
+void BeachLine::PrintToDot(TreeNode* node, std::ostream& dot_file) {
     if (node == nullptr) {
         return;
     }
 
     // Node
-    int id = node->GetId();
+    uintptr_t id = node->GetId();
     dot_file << id << "[label=\"leaf(" << node->IsLeaf() << ")";
     if (node->IsLeaf()) {
         LeafNode* curr = nullptr;
@@ -248,15 +227,12 @@ void BeachLine::PrintToDot(TreeNode* node, std::ofstream& dot_file) {
         dot_file << id << " -> " << node->GetParent()->GetId() << "[color=red style=dashed]\n";
 }
 
-void BeachLine::Draw(std::string name) {
-    std::ofstream dot_file;
-    dot_file.open(name + ".dot");
+std::string BeachLine::ToDot() {
+    std::ostringstream dot_file;
     dot_file << "digraph{\n";
     PrintToDot(root, dot_file);
     dot_file << "}\n";
-    dot_file.close();
-    std::string command = "dot -Tpng " + name + ".dot -o " + name + ".png";
-    system(command.c_str());
+    return dot_file.str();
 }
 
 void BeachLine::Cleanup(TreeNode* curr) {
@@ -289,26 +265,28 @@ void BeachLine::SetOrientations(double sw_y) {
 }
 
 void BeachLine::SetOrientation(InternalNode* curr, double sw_y) {
-    Dcel::HalfEdge* half_edge = curr->GetHalfEdge();
-    Dcel::HalfEdge* edge = (half_edge->origin == nullptr) ? half_edge->twin : half_edge;
+    int half_edge = curr->GetHalfEdge();
+    int edge_idx = (dcel->Origin(half_edge) == Dcel::kNone) ? dcel->Twin(half_edge) : half_edge;
+    assert(dcel->Origin(edge_idx) != Dcel::kNone);
+    Dcel::HalfEdge& edge = dcel->half_edges[edge_idx];
 
     // 'edge' is the one with origin, find near and far point
-    geometry::Point near = edge->origin->point;
+    geometry::Point near = dcel->OriginPoint(edge_idx);
     geometry::Point far =
         geometry::FindParabolaIntersection(sites[curr->GetSites().first], sites[curr->GetSites().second], sw_y);
 
     // Compare near and far to set the orientation
-    if (edge->line.vertical) {
+    if (edge.line.vertical) {
         if (near.y < far.y) {
-            edge->line.dir = 'u';
+            edge.line.dir = 'u';
         } else {
-            edge->line.dir = 'd';
+            edge.line.dir = 'd';
         }
     } else {
         if (near.x < far.x) {
-            edge->line.dir = 'r';
+            edge.line.dir = 'r';
         } else if (near.x > far.x) {
-            edge->line.dir = 'l';
+            edge.line.dir = 'l';
         }
     }
 
@@ -320,3 +298,85 @@ void BeachLine::SetOrientation(InternalNode* curr, double sw_y) {
         SetOrientation(static_cast<InternalNode*>(curr->GetRight()), sw_y);
     }
 }
+
+
+void BeachLine::Replace(TreeNode* old, TreeNode* nw) {
+    TreeNode* parent = old->GetParent();
+    if (parent == nullptr) {
+        root = nw;
+    } else if (parent->GetLeft() == old) {
+        parent->SetLeft(nw);
+    } else {
+        parent->SetRight(nw);
+    }
+    nw->SetParent(parent);
+}
+
+void BeachLine::Link(InternalNode* parent, TreeNode* left, TreeNode* right) {
+    parent->SetLeft(left);
+    left->SetParent(parent);
+    parent->SetRight(right);
+    right->SetParent(parent);
+    UpdateHeight(parent);
+}
+
+void BeachLine::UpdateHeight(TreeNode* node) {
+    if (node->IsLeaf()) {
+        node->SetHeight(1);
+        return;
+    }
+    node->SetHeight(std::max(node->GetLeft()->GetHeight(), node->GetRight()->GetHeight()) + 1);
+}
+
+int BeachLine::BalanceFactor(TreeNode* node) {
+    if (node->IsLeaf()) {
+        return 0;
+    }
+    return node->GetLeft()->GetHeight() - node->GetRight()->GetHeight();
+}
+
+TreeNode* BeachLine::RotateLeft(TreeNode* node) {
+    // The right child is internal since the node is right-heavy
+    TreeNode* pivot = node->GetRight();
+    Replace(node, pivot);
+    node->SetRight(pivot->GetLeft());
+    pivot->GetLeft()->SetParent(node);
+    pivot->SetLeft(node);
+    node->SetParent(pivot);
+    UpdateHeight(node);
+    UpdateHeight(pivot);
+    return pivot;
+}
+
+TreeNode* BeachLine::RotateRight(TreeNode* node) {
+    // The left child is internal since the node is left-heavy
+    TreeNode* pivot = node->GetLeft();
+    Replace(node, pivot);
+    node->SetLeft(pivot->GetRight());
+    pivot->GetRight()->SetParent(node);
+    pivot->SetRight(node);
+    node->SetParent(pivot);
+    UpdateHeight(node);
+    UpdateHeight(pivot);
+    return pivot;
+}
+
+void BeachLine::Rebalance(TreeNode* node) {
+    // Walk up to the root, fixing heights and rotating where the subtrees differ by two
+    while (node != nullptr) {
+        UpdateHeight(node);
+        int balance = BalanceFactor(node);
+        if (balance > 1) {
+            if (BalanceFactor(node->GetLeft()) < 0) {
+                RotateLeft(node->GetLeft());
+            }
+            node = RotateRight(node);
+        } else if (balance < -1) {
+            if (BalanceFactor(node->GetRight()) > 0) {
+                RotateRight(node->GetRight());
+            }
+            node = RotateLeft(node);
+        }
+        node = node->GetParent();
+    }
+}
\ No newline at end of file
@@ -1,11 +1,11 @@
 #pragma once
-#include <fstream>
+#include <cstdint>
+#include <ostream>
+#include <string>
 #include "dcel.h"
 #include "event.h"
 #include "geometry.h"
 
-class CircleEvent;
-
 class TreeNode {
    public:
     TreeNode(bool leaf);
@@ -13,17 +13,19 @@ class TreeNode {
     void SetLeft(TreeNode* left) { this->left = left; }
     void SetRight(TreeNode* right) { this->right = right; }
     void SetParent(TreeNode* parent) { this->parent = parent; }
+    void SetHeight(int height) { this->height = height; }
     TreeNode* GetLeft() { return left; }
     TreeNode* GetRight() { return right; }
     TreeNode* GetParent() { return parent; }
-    int GetId() { return id; }
+    int GetHeight() { return height; }
+    uintptr_t GetId() { return reinterpret_cast<uintptr_t>(this); }  // For graphviz
     bool IsLeaf() { return leaf; }
 
    private:
     TreeNode* left;
     TreeNode* right;
     TreeNode* parent;
-    int id;  // For graphviz
+    int height;  // For AVL balancing, leaves have height 1
     bool leaf;
 };
 
@@ -31,37 +33,40 @@ class LeafNode : public TreeNode {
    public:
     LeafNode(int site);
 
-    void SetCircleEvent(CircleEvent* circle_event) { this->circle_event = circle_event; }
+    void SetCircleEvent(int circle_event) { this->circle_event = circle_event; }
     int GetSite() { return site; }
-    CircleEvent* GetCircleEvent() { return circle_event; }
+    int GetCircleEvent() { return circle_event; }
 
    private:
     int site;
-    CircleEvent* circle_event;
+    int circle_event;  // Id in the event queue
 };
 
 class InternalNode : public TreeNode {
    public:
-    InternalNode(std::pair<int, int> sites, Dcel::HalfEdge* half_edge);
+    InternalNode(std::pair<int, int> sites, int half_edge);
 
     std::pair<int, int> GetSites() { return sites; }
     void SetSites(std::pair<int, int> sites) { this->sites = sites; }
-    Dcel::HalfEdge* GetHalfEdge() { return half_edge; }
-    void SetHalfEdge(Dcel::HalfEdge* half_edge) { this->half_edge = half_edge; }
+    int GetHalfEdge() { return half_edge; }
+    void SetHalfEdge(int half_edge) { this->half_edge = half_edge; }
 
    private:
     std::pair<int, int> sites;
-    Dcel::HalfEdge* half_edge;
+    int half_edge;  // Index in the DCEL
 };
 
 // A BST that holds information about the beach line
 // Internal nodes represent parabola intersections
 // Leaf nodes represent arcs of the beach line
-// TODO: add balancing operations (integrate AVL ops?)
+// Kept balanced as an AVL tree; rotations preserve the in-order sequence, so every
+// internal node still separates the same two neighbouring arcs
+
 class BeachLine {
    public:
     ~BeachLine();
     void SetSites(const std::vector<geometry::Point>& sites) { this->sites = sites; }
+    void SetDcel(Dcel* dcel) { this->dcel = dcel; }
     TreeNode* GetRoot();
     LeafNode* GetFirstLeaf();
 
@@ -83,28 +88,44 @@ class BeachLine {
     InternalNode* FindSuccLca(LeafNode* leaf);
 
     // First insertion is treated differently
-    void InitialInsert(int site, Dcel::HalfEdge* he);
+    void InitialInsert(int site, int he);
 
     // Regular insertion
-    LeafNode* Insert(LeafNode* curr, int site, Dcel::HalfEdge* upper, Dcel::HalfEdge* lower);
+    LeafNode* Insert(LeafNode* curr, int site, int upper, int lower);
 
     // Deletion
-    std::pair<Dcel::HalfEdge*, Dcel::HalfEdge*> Delete(LeafNode* arc, Dcel::HalfEdge* down);
+    std::pair<int, int> Delete(LeafNode* arc, int down);
 
     // Sets half-edge orientations
     void SetOrientations(double sw_y);
 
     // Prints for GraphViz
-    void PrintToDot(TreeNode* curr, std::ofstream& dot_file);
-    void Draw(std::string name);
+    void PrintToDot(TreeNode* curr, std::ostream& dot_file);
+    std::string ToDot();
 
    private:
     std::vector<geometry::Point> sites;
+    Dcel* dcel = nullptr;  // Holds the half-edges traced by internal nodes
     TreeNode* root = nullptr;
 
     // Sets half-edge orientation
     void SetOrientation(InternalNode* curr, double sw_y);
 
+    // Puts 'nw' in the place of 'old' in the tree
+    void Replace(TreeNode* old, TreeNode* nw);
+
+    // Hangs 'left' and 'right' below 'parent'
+    void Link(InternalNode* parent, TreeNode* left, TreeNode* right);
+
+    // AVL helpers
+    void UpdateHeight(TreeNode* node);
+    int BalanceFactor(TreeNode* node);
+    TreeNode* RotateLeft(TreeNode* node);
+    TreeNode* RotateRight(TreeNode* node);
+
+    // Restores the AVL property on the path from 'node' to the root
+    void Rebalance(TreeNode* node);
+
     // Deletes everything
     void Cleanup(TreeNode* curr);
 };
\ No newline at end of file
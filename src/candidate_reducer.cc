@@ -0,0 +1,86 @@
+#include "candidate_reducer.h"
+
+#include <algorithm>
+#include <cmath>
+
+CandidateReducer::CandidateReducer(int top_k, bool keep_all) {
+    this->top_k = std::max(1, top_k);
+    this->keep_all = keep_all;
+    best.width = 0;
+    best.seq = -1;
+}
+
+void CandidateReducer::Add(const geometry::Annulus& ann) {
+    Rank(ann);
+    if (keep_all) all.push_back(ann);
+}
+
+void CandidateReducer::Rank(const geometry::Annulus& ann) {
+    Entry entry = {ann.r_outer - ann.r_inner, count++, ann};
+    if (best.seq == -1 || Better(entry, best)) best = entry;
+
+    // The best is always kept, the rest only if asked for
+    if (top_k == 1) return;
+    if (static_cast<int>(top.size()) < top_k) {
+        top.push_back(entry);
+        std::push_heap(top.begin(), top.end(), Better);
+    } else if (Better(entry, top.front())) {
+        std::pop_heap(top.begin(), top.end(), Better);
+        top.back() = entry;
+        std::push_heap(top.begin(), top.end(), Better);
+    }
+}
+
+void CandidateReducer::Merge(const CandidateReducer& other) {
+    if (other.best.seq == -1) return;
+
+    // Only the kept candidates of the other reducer can make it, ranked in their order of arrival
+    std::vector<Entry> entries = other.SortedTop();
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.seq < b.seq; });
+    for (const Entry& entry : entries) {
+        Rank(entry.ann);
+    }
+    if (keep_all) all.insert(all.end(), other.all.begin(), other.all.end());
+}
+
+void CandidateReducer::Verify(const WidthEvaluator& evaluator) {
+    if (best.seq == -1) return;
+
+    // All kept centers in one block, so the points are only read once
+    std::vector<Entry> entries = SortedTop();
+    int sz = entries.size();
+    std::vector<geometry::Point> centers;
+    for (const Entry& entry : entries) {
+        centers.push_back(entry.ann.center);
+    }
+    std::vector<double> min_sq(sz), max_sq(sz);
+    evaluator.MinMaxSquaredDist(centers.data(), sz, min_sq.data(), max_sq.data());
+
+    // Arrival order stays, so ties are still broken the same way
+    for (int i = 0; i < sz; i++) {
+        Entry& entry = entries[i];
+        entry.ann.r_inner = std::sqrt(min_sq[i]);
+        entry.ann.r_outer = std::sqrt(max_sq[i]);
+        entry.width = entry.ann.r_outer - entry.ann.r_inner;
+    }
+    best = *std::min_element(entries.begin(), entries.end(), Better);
+    if (top_k > 1) {
+        top = entries;
+        std::make_heap(top.begin(), top.end(), Better);
+    }
+}
+
+std::vector<CandidateReducer::Entry> CandidateReducer::SortedTop() const {
+    std::vector<Entry> entries = top;
+    if (top_k == 1 && best.seq != -1) entries = {best};
+    std::sort(entries.begin(), entries.end(), Better);
+    return entries;
+}
+
+std::vector<geometry::Annulus> CandidateReducer::GetTop() const {
+    std::vector<geometry::Annulus> anns;
+    for (const Entry& entry : SortedTop()) {
+        anns.push_back(entry.ann);
+    }
+    return anns;
+}
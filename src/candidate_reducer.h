@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include "geometry.h"
+#include "width_evaluator.h"
+
+// Keeps the best annulus candidates as they come, instead of storing and sorting all of them
+// Candidates are ranked by width, ties go to the one that came first
+class CandidateReducer {
+   public:
+    // Keeps the 'top_k' best candidates, and all of them if 'keep_all' is set (for drawing)
+    CandidateReducer(int top_k = 1, bool keep_all = false);
+
+    void Add(const geometry::Annulus& ann);
+
+    // Adds all candidates of another reducer with the same settings, as if they came after the ones
+    // already added
+    void Merge(const CandidateReducer& other);
+
+    // Measures the kept candidates again against all points and ranks them by the measured widths
+    // A candidate built from a wrong site claims a thinner annulus than its center gives, this catches it.
+    // Candidates that were already dropped are not brought back
+    void Verify(const WidthEvaluator& evaluator);
+
+    // The best candidate, an annulus with r_inner = r_outer = -1 if there were none
+    geometry::Annulus GetBest() const { return best.ann; }
+
+    // The best candidates, best first
+    std::vector<geometry::Annulus> GetTop() const;
+
+    // All candidates in the order they came, empty unless 'keep_all' is set
+    const std::vector<geometry::Annulus>& GetAll() const { return all; }
+
+    int GetTopK() const { return top_k; }
+
+    bool GetKeepAll() const { return keep_all; }
+
+   private:
+    struct Entry {
+        double width;
+        long long seq;  // Arrival order, breaks ties
+        geometry::Annulus ann;
+    };
+
+    // Strict ranking, better first
+    static bool Better(const Entry& a, const Entry& b) {
+        return a.width < b.width || (a.width == b.width && a.seq < b.seq);
+    }
+
+    // Updates the best candidates
+    void Rank(const geometry::Annulus& ann);
+
+    // The kept entries sorted best first
+    std::vector<Entry> SortedTop() const;
+
+    int top_k;
+    bool keep_all;
+    long long count = 0;
+    Entry best;
+    std::vector<Entry> top;  // Heap with the worst of the kept candidates on top
+    std::vector<geometry::Annulus> all;
+};
@@ -0,0 +1,190 @@
+#include <dirent.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "min_annulus_solver.h"
+#include "point_io.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+namespace {
+
+// The .in files of a directory, sorted by name, or the paths listed in a manifest, one per line
+bool ListInputs(const string& path, vector<string>* inputs) {
+    DIR* dir = opendir(path.c_str());
+    if (dir != nullptr) {
+        string prefix = (path.back() == '/') ? path : path + "/";
+        while (dirent* entry = readdir(dir)) {
+            string name = entry->d_name;
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, ".in") == 0) {
+                inputs->push_back(prefix + name);
+            }
+        }
+        closedir(dir);
+        sort(inputs->begin(), inputs->end());
+        return true;
+    }
+    ifstream manifest(path);
+    if (!manifest) {
+        return false;
+    }
+    string line;
+    while (getline(manifest, line)) {
+        if (!line.empty()) inputs->push_back(line);
+    }
+    return true;
+}
+
+// Solves every input on its own, spread over one thread per core, and lists the results in input order
+// followed by the throughput and the latency percentiles (loading included)
+int RunBatch(const string& path, MinAnnulusSolver::Engine engine) {
+    vector<string> inputs;
+    if (!ListInputs(path, &inputs)) {
+        std::cout << "Error: cannot open " << path << endl;
+        return 1;
+    }
+
+    // Each solve runs on one thread, the pool only goes over the inputs
+    MinAnnulusSolver solver(0, 1, engine);
+    int num_inputs = inputs.size();
+    vector<geometry::Annulus> results(num_inputs);
+    vector<bool> loaded(num_inputs);
+    vector<double> latencies(num_inputs);
+    ThreadPool pool(ThreadPool::DefaultNumThreads());
+    auto start = chrono::steady_clock::now();
+    pool.Run(num_inputs, [&](int i, int) {
+        auto part_start = chrono::steady_clock::now();
+        vector<geometry::Point> points;
+        geometry::PointSetInfo info;
+        loaded[i] = point_io::Load(inputs[i], &points, &info, 1);
+        if (loaded[i]) results[i] = solver.Solve(points.data(), points.size(), info);
+        latencies[i] = chrono::duration<double>(chrono::steady_clock::now() - part_start).count();
+    });
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    for (int i = 0; i < num_inputs; i++) {
+        const geometry::Annulus& ann = results[i];
+        if (!loaded[i]) {
+            printf("%s error: cannot read\n", inputs[i].c_str());
+            continue;
+        }
+        printf("%s center = (%.6f, %.6f) r_inner = %.6f r_outer = %.6f width = %.6f\n", inputs[i].c_str(),
+               ann.center.x, ann.center.y, ann.r_inner, ann.r_outer, ann.r_outer - ann.r_inner);
+    }
+    if (num_inputs == 0) return 0;
+
+    // Nearest-rank percentiles
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        int rank = static_cast<int>(ceil(p * num_inputs));
+        return latencies[max(rank, 1) - 1] * 1e3;
+    };
+    printf("%d parts in %.3f s on %d threads, %.1f parts/sec, p50 = %.3f ms, p99 = %.3f ms\n", num_inputs, secs,
+           pool.GetNumThreads(), num_inputs / secs, percentile(0.5), percentile(0.99));
+    return 0;
+}
+
+}  // namespace
+
+// Headless version, no SFML and no visualization
+// To run: ./min-annulus-cli [--exchange] [--top k | --approx eps] <testcase_path>
+//     or: ./min-annulus-cli [--exchange] --batch <directory | manifest>
+//     or: ./min-annulus-cli --to-binary <output_path> <testcase_path>
+// Testcases are text or the binary format of point_io.h
+// With --exchange, nearly circular inputs are solved without the diagrams (see exchange_solver.h)
+// With --top, the k best candidates are listed before the winning annulus
+// With --approx, the width is only found to within a relative 'eps', its bounds are listed first
+// With --batch, every .in file of the directory or every path in the manifest (one per line) is solved, in
+// parallel, with one result line each
+// With --to-binary, the testcase is only converted to the binary format
+int main(int argc, char* argv[]) {
+    // Grab command-line arguments
+    int top_k = 1;
+    double eps = -1;
+    bool batch = false;
+    string binary_path;
+    MinAnnulusSolver::Engine engine = MinAnnulusSolver::kDiagrams;
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--top" && i + 1 < argc) {
+            top_k = atoi(argv[++i]);
+        } else if (string(argv[i]) == "--exchange") {
+            engine = MinAnnulusSolver::kExchange;
+        } else if (string(argv[i]) == "--approx" && i + 1 < argc) {
+            eps = atof(argv[++i]);
+        } else if (string(argv[i]) == "--batch") {
+            batch = true;
+        } else if (string(argv[i]) == "--to-binary" && i + 1 < argc) {
+            binary_path = argv[++i];
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.size() != 1 || top_k < 1) {
+        std::cout << "Error: expected one testcase path (or batch input) and k >= 1." << endl;
+        std::cout << "Usage: " << argv[0] << " [--exchange] [--top k | --approx eps] <testcase_path>" << endl;
+        std::cout << "   or: " << argv[0] << " [--exchange] --batch <directory | manifest>" << endl;
+        std::cout << "   or: " << argv[0] << " --to-binary <output_path> <testcase_path>" << endl;
+        return 1;
+    }
+    if (eps != -1 && (eps < 0 || top_k > 1)) {
+        std::cout << "Error: --approx needs a non-negative eps and can't be combined with --top." << endl;
+        return 1;
+    }
+    if (batch) {
+        if (eps != -1 || top_k > 1) {
+            std::cout << "Error: --batch can't be combined with --top or --approx." << endl;
+            return 1;
+        }
+        return RunBatch(args[0], engine);
+    }
+
+    // Load the testcase
+    vector<geometry::Point> points;
+    geometry::PointSetInfo info;
+    if (!point_io::Load(args[0], &points, &info, 0)) {
+        std::cout << "Error: cannot read " << args[0] << endl;
+        return 1;
+    }
+    if (!binary_path.empty()) {
+        if (!point_io::WriteBinary(binary_path, points)) {
+            std::cout << "Error: cannot write " << binary_path << endl;
+            return 1;
+        }
+        printf("%d points written to %s\n", static_cast<int>(points.size()), binary_path.c_str());
+        return 0;
+    }
+
+    // Compute both diagrams and combine them, skipping all visualization, on one thread per core since this is
+    // the only solve running
+    MinAnnulusSolver solver(0, 0, engine);
+    vector<geometry::Annulus> top;
+    if (eps >= 0) {
+        MinAnnulusSolver::ApproxAnnulus approx = solver.SolveApprox(points, eps);
+        printf("width in [%.6f, %.6f], core set of %d points%s\n", approx.lower, approx.upper, approx.core_size,
+               approx.converged ? "" : ", not converged");
+        top = {approx.annulus};
+    } else if (top_k == 1) {
+        top = {solver.Solve(points.data(), points.size(), info)};
+    } else {
+        top = solver.SolveTop(points.data(), points.size(), top_k, info);
+    }
+    geometry::Annulus ann = top.empty() ? geometry::Annulus() : top[0];
+    if (top_k > 1) {
+        for (int i = 0; i < static_cast<int>(top.size()); i++) {
+            printf("#%d center = (%.6f, %.6f) width = %.6f\n", i + 1, top[i].center.x, top[i].center.y,
+                   top[i].r_outer - top[i].r_inner);
+        }
+    }
+
+    // Report the winning annulus
+    printf("center = (%.6f, %.6f)\n", ann.center.x, ann.center.y);
+    printf("r_inner = %.6f\n", ann.r_inner);
+    printf("r_outer = %.6f\n", ann.r_outer);
+    printf("width = %.6f\n", ann.r_outer - ann.r_inner);
+    return 0;
+}
@@ -0,0 +1,35 @@
+#include "core_set.h"
+
+#include <algorithm>
+
+CoreSet::CoreSet(const geometry::Point* points, int n) : points(points), n(n), taken(n, false) {}
+
+int CoreSet::AddExtremes(geometry::Point center, int num_sectors) {
+    // Nearest and farthest point of every sector by squared distance
+    std::vector<int> nearest(num_sectors, -1), farthest(num_sectors, -1);
+    std::vector<double> near_sq(num_sectors), far_sq(num_sectors);
+    for (int i = 0; i < n; i++) {
+        double dx = points[i].x - center.x, dy = points[i].y - center.y;
+        double d = dx * dx + dy * dy;
+        int sector = std::min(num_sectors - 1, static_cast<int>(geometry::PseudoAngle(dx, dy) * num_sectors / 4));
+        if (nearest[sector] == -1 || d < near_sq[sector]) {
+            nearest[sector] = i;
+            near_sq[sector] = d;
+        }
+        if (farthest[sector] == -1 || d > far_sq[sector]) {
+            farthest[sector] = i;
+            far_sq[sector] = d;
+        }
+    }
+
+    int added = 0;
+    for (int sector = 0; sector < num_sectors; sector++) {
+        for (int idx : {nearest[sector], farthest[sector]}) {
+            if (idx == -1 || taken[idx]) continue;
+            taken[idx] = true;
+            core.push_back(points[idx]);
+            added++;
+        }
+    }
+    return added;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include "geometry.h"
+
+// A small subset of the input that an annulus is solved on instead of all points
+// The plane around a center is cut into angular sectors, and the nearest and the farthest point of each
+// sector are kept: they are the ones that can touch the inner and the outer circle of an annulus around
+// a nearby center. The size only depends on the number of sectors, not on the number of points
+class CoreSet {
+   public:
+    // The points are not copied, they have to outlive the core set
+    CoreSet(const geometry::Point* points, int n);
+
+    // Adds the nearest and the farthest point of each of 'num_sectors' sectors around 'center'
+    // Returns the number of points that were not in the core set yet
+    int AddExtremes(geometry::Point center, int num_sectors);
+
+    // The points kept so far, each once, in the order they were added
+    const std::vector<geometry::Point>& GetPoints() const { return core; }
+
+   private:
+    const geometry::Point* points;
+    int n;
+    std::vector<geometry::Point> core;
+    std::vector<bool> taken;
+};
@@ -1,55 +1,118 @@
 #include "dcel.h"
 #include <cstdio>
 
-Dcel::~Dcel() {
-    for (auto v : vertices) delete v;
-    for (auto he : half_edges) delete he;
-    for (auto f : faces) delete f;
+const int Dcel::kNone;
+
+int Dcel::AddVertex(geometry::Point point, bool box) {
+    vertices.emplace_back(point, box);
+    return vertices.size() - 1;
+}
+
+int Dcel::AddFace(int site) {
+    faces.emplace_back(site);
+    return faces.size() - 1;
+}
+
+int Dcel::AddHalfEdge() {
+    half_edges.emplace_back();
+    return half_edges.size() - 1;
+}
+
+std::pair<int, int> Dcel::AddEdge() {
+    int fst = AddHalfEdge();
+    int snd = AddHalfEdge();
+    half_edges[fst].twin = snd;
+    half_edges[snd].twin = fst;
+    return {fst, snd};
+}
+
+std::vector<int> Dcel::Compact() {
+    // Move the survivors to the front and remember where they went
+    std::vector<int> vertex_remap(vertices.size(), kNone);
+    int vertex_cnt = 0;
+    for (int i = 0; i < static_cast<int>(vertices.size()); i++) {
+        if (vertices[i].removed) continue;
+        vertex_remap[i] = vertex_cnt;
+        vertices[vertex_cnt++] = vertices[i];
+    }
+    vertices.erase(vertices.begin() + vertex_cnt, vertices.end());
+
+    std::vector<int> edge_remap(half_edges.size(), kNone);
+    int edge_cnt = 0;
+    for (int i = 0; i < static_cast<int>(half_edges.size()); i++) {
+        if (half_edges[i].removed) continue;
+        edge_remap[i] = edge_cnt;
+        half_edges[edge_cnt++] = half_edges[i];
+    }
+    half_edges.erase(half_edges.begin() + edge_cnt, half_edges.end());
+
+    // Fix all references
+    auto remap = [](const std::vector<int>& new_idx, int idx) { return (idx == kNone) ? kNone : new_idx[idx]; };
+    for (HalfEdge& he : half_edges) {
+        he.origin = remap(vertex_remap, he.origin);
+        he.twin = remap(edge_remap, he.twin);
+        he.next = remap(edge_remap, he.next);
+        he.prev = remap(edge_remap, he.prev);
+    }
+    for (Vertex& v : vertices) {
+        v.incident_halfedge = remap(edge_remap, v.incident_halfedge);
+    }
+    for (Face& f : faces) {
+        f.outer_component = remap(edge_remap, f.outer_component);
+        std::vector<int> inner_components;
+        for (int he : f.inner_components) {
+            if (edge_remap[he] != kNone) inner_components.push_back(edge_remap[he]);
+        }
+        f.inner_components = inner_components;
+    }
+    return edge_remap;
 }
 
 void Dcel::Print() {
     printf("=== Printing DCEL ===\n");
     printf("Vertices:\n");
-    for (Vertex* v : vertices) {
-        printf("point=(%.2f %.2f) incident_halfedge=\n", v->point.x, v->point.y);
-        if (v->incident_halfedge == nullptr)
+    for (const Vertex& v : vertices) {
+        printf("point=(%.2f %.2f) incident_halfedge=\n", v.point.x, v.point.y);
+        if (v.incident_halfedge == kNone)
             printf("NONE\n");
         else
-            v->incident_halfedge->Print();
+            PrintHalfEdge(v.incident_halfedge);
     }
     printf("Faces:\n");
-    for (Face* f : faces) {
-        printf("site=%d ", f->site);
-        if (f->outer_component != nullptr) {
-            printf("outer component: ((%.2f %.2f)->(%.2f %.2f)) ", f->outer_component->origin->point.x,
-                   f->outer_component->origin->point.y, f->outer_component->twin->origin->point.x,
-                   f->outer_component->twin->origin->point.y);
+    for (const Face& f : faces) {
+        printf("site=%d ", f.site);
+        if (f.outer_component != kNone) {
+            int he = f.outer_component;
+            printf("outer component: ((%.2f %.2f)->(%.2f %.2f)) ", OriginPoint(he).x, OriginPoint(he).y,
+                   OriginPoint(Twin(he)).x, OriginPoint(Twin(he)).y);
         }
-        if (f->inner_components.size() > 0) {
+        if (f.inner_components.size() > 0) {
             printf("inner components: ");
-            for (HalfEdge* he : f->inner_components) {
-                he->Print();
-                printf("\nic: ((%.2f %.2f)->(%.2f %.2f)) ", he->origin->point.x, he->origin->point.y,
-                       he->twin->origin->point.x, he->twin->origin->point.y);
+            for (int he : f.inner_components) {
+                PrintHalfEdge(he);
+                printf("\nic: ((%.2f %.2f)->(%.2f %.2f)) ", OriginPoint(he).x, OriginPoint(he).y,
+                       OriginPoint(Twin(he)).x, OriginPoint(Twin(he)).y);
             }
         }
         printf("\n");
     }
     printf("HalfEdges:\n");
-    for (HalfEdge* he : half_edges) {
-        he->Print();
-        printf("Line: vertical = %d | (k, n, x) = (%.2f %.2f %.2f) | dir = %c\n", he->line.vertical, he->line.k,
-               he->line.n, he->line.x, he->line.dir);
+    int sz = half_edges.size();
+    for (int he = 0; he < sz; he++) {
+        const HalfEdge& edge = half_edges[he];
+        PrintHalfEdge(he);
+        printf("Line: vertical = %d | (k, n, x) = (%.2f %.2f %.2f) | dir = %c\n", edge.line.vertical, edge.line.k,
+               edge.line.n, edge.line.x, edge.line.dir);
         printf("Neighbours!\n");
-        if (he->next != nullptr) {
+        if (edge.next != kNone) {
             printf("Next:\n");
-            he->next->Print();
+            PrintHalfEdge(edge.next);
         } else {
             printf("Next: NO\n");
         }
-        if (he->prev != nullptr) {
+        if (edge.prev != kNone) {
             printf("Prev:\n");
-            he->prev->Print();
+            PrintHalfEdge(edge.prev);
         } else {
             printf("Prev: NO\n");
         }
@@ -58,20 +121,22 @@ void Dcel::Print() {
     printf("=== Done printing DCEL ===\n");
 }
 
-void Dcel::HalfEdge::Print() {
+void Dcel::PrintHalfEdge(int he) {
+    const HalfEdge& edge = half_edges[he];
+
     // Origins
-    if (origin != nullptr)
-        printf("((%.2f %.2f)->", origin->point.x, origin->point.y);
+    if (edge.origin != kNone)
+        printf("((%.2f %.2f)->", OriginPoint(he).x, OriginPoint(he).y);
     else
         printf("((NO_ORIGIN)->");
 
-    if (twin != nullptr && twin->origin != nullptr)
-        printf("(%.2f %.2f))\n", twin->origin->point.x, twin->origin->point.y);
+    if (edge.twin != kNone && Origin(edge.twin) != kNone)
+        printf("(%.2f %.2f))\n", OriginPoint(edge.twin).x, OriginPoint(edge.twin).y);
     else
         printf("((NO_TWIN_ORIGIN))\n");
 
-    if (incident_face != nullptr)
-        printf("incident_face=%d\n", incident_face->site);
+    if (edge.incident_face != kNone)
+        printf("incident_face=%d\n", faces[edge.incident_face].site);
     else
         printf("incident_face=NONE\n");
-}
\ No newline at end of file
+}
@@ -2,59 +2,87 @@
 #include <vector>
 #include "geometry.h"
 
+// Doubly connected edge list
+// Vertices, half-edges and faces live in contiguous arrays and refer to each other by index
 class Dcel {
    public:
-    ~Dcel();
-
-    struct Vertex;
-    struct Face;
-    struct HalfEdge;
-
-    // Prints the whole DCEL
-    void Print();
+    static const int kNone = -1;  // Missing reference, e.g. an edge going to infinity has no origin
 
     struct Vertex {
         geometry::Point point;
-        HalfEdge* incident_halfedge;
-        bool box;  // Is this a box vertex?
+        int incident_halfedge;
+        bool box;      // Is this a box vertex?
+        bool removed;  // Tombstone, dropped on Compact()
 
-        Vertex(geometry::Point point) {
+        Vertex(geometry::Point point, bool box) {
             this->point = point;
-            incident_halfedge = nullptr;
-            box = false;
+            this->box = box;
+            incident_halfedge = kNone;
+            removed = false;
         }
-        Vertex(geometry::Point point, bool box) : Vertex(point) { this->box = box; }
     };
 
     struct Face {
-        HalfEdge* outer_component;
-        std::vector<HalfEdge*> inner_components;
+        int outer_component;
+        std::vector<int> inner_components;
         int site;  // Index of the site tied to this face
         Face(int site) {
             this->site = site;
-            outer_component = nullptr;
+            outer_component = kNone;
         }
     };
 
     struct HalfEdge {
-        Vertex* origin;
-        HalfEdge* twin;
-        Face* incident_face;
-        HalfEdge* next;
-        HalfEdge* prev;
+        int origin;
+        int twin;
+        int incident_face;
+        int next;
+        int prev;
         geometry::Line line;  // Line equation
+        bool removed;         // Tombstone, dropped on Compact()
 
         HalfEdge() {
-            origin = nullptr;
-            incident_face = nullptr;
-            twin = next = prev = nullptr;
+            origin = twin = incident_face = next = prev = kNone;
+            removed = false;
         }
-
-        // Prints a half-edge
-        void Print();
     };
 
-    std::vector<Vertex*> vertices;
-    std::vector<Face*> faces;
-    std::vector<HalfEdge*> half_edges;
-};
\ No newline at end of file
+    // Add new elements and return their indices
+    // Note: references to elements are invalidated by adding more elements of the same kind
+    int AddVertex(geometry::Point point, bool box = false);
+    int AddFace(int site);
+    int AddHalfEdge();
+
+    // Adds a pair of twin half-edges, returns their indices
+    std::pair<int, int> AddEdge();
+
+    // Drops the removed vertices and half-edges and renumbers the rest, references to removed
+    // elements become kNone. Returns the new index of every old half-edge
+    std::vector<int> Compact();
+
+    // Shortcuts for common lookups
+    // References to removed elements read as kNone, just like after Compact()
+    int Twin(int he) const { return half_edges[he].twin; }
+    int Origin(int he) const {
+        int v = half_edges[he].origin;
+        return (v == kNone || vertices[v].removed) ? kNone : v;
+    }
+    int Next(int he) const { return Live(half_edges[he].next); }
+    int Prev(int he) const { return Live(half_edges[he].prev); }
+    int Site(int he) const { return faces[half_edges[he].incident_face].site; }
+    geometry::Point OriginPoint(int he) const { return vertices[half_edges[he].origin].point; }
+    bool OriginOnBox(int he) const { return vertices[half_edges[he].origin].box; }
+
+    // Prints the whole DCEL
+    void Print();
+
+    // Prints a half-edge
+    void PrintHalfEdge(int he);
+
+    // Half-edge index, or kNone if it's removed
+    int Live(int he) const { return (he == kNone || half_edges[he].removed) ? kNone : he; }
+
+    std::vector<Vertex> vertices;
+    std::vector<Face> faces;
+    std::vector<HalfEdge> half_edges;
+};
@@ -1,15 +1,137 @@
 #include "event.h"
 
+#include <algorithm>
+#include <cassert>
+
+const int EventQueue::kNone;
+
 Event::Event(double x, double y, char type) {
     this->x = x;
     this->y = y;
     this->type = type;
 }
 
+CircleEvent::CircleEvent() : Event(0, 0, 'c') { this->arc = nullptr; }
+
 CircleEvent::CircleEvent(double y, geometry::Point center, LeafNode* arc) : Event(center.x, y, 'c') {
     this->center = center;
     this->arc = arc;
-    this->false_alarm = false;
 }
 
 SiteEvent::SiteEvent(double x, double y, int site) : Event(x, y, 's') { this->site = site; }
+
+void EventQueue::Init(const std::vector<geometry::Point>& sites, bool sorted) {
+    site_events.clear();
+    int sz = sites.size();
+    for (int i = 0; i < sz; i++) {
+        site_events.push_back(SiteEvent(sites[i].x, sites[i].y, i));
+    }
+
+    // Decreasing y, ties by decreasing x
+    if (!sorted) {
+        std::stable_sort(site_events.begin(), site_events.end(),
+                         [](const SiteEvent& a, const SiteEvent& b) { return b < a; });
+    }
+    next_site = 0;
+}
+
+bool EventQueue::Empty() const { return next_site == static_cast<int>(site_events.size()) && heap.empty(); }
+
+char EventQueue::NextType() const {
+    if (heap.empty()) return 's';
+    if (next_site == static_cast<int>(site_events.size())) return 'c';
+
+    // Sites go first on ties
+    return (site_events[next_site] < circle_events[heap[0]]) ? 'c' : 's';
+}
+
+double EventQueue::NextY() const {
+    if (NextType() == 's') {
+        return site_events[next_site].GetY();
+    }
+    return circle_events[heap[0]].GetY();
+}
+
+SiteEvent EventQueue::PopSiteEvent() {
+    assert(NextType() == 's');
+    return site_events[next_site++];
+}
+
+CircleEvent EventQueue::PopCircleEvent() {
+    assert(NextType() == 'c');
+    int id = heap[0];
+    CircleEvent event = circle_events[id];
+    RemoveAt(0);
+    free_ids.push_back(id);
+    return event;
+}
+
+int EventQueue::AddCircleEvent(const CircleEvent& event) {
+    // Reuse a free slot if there is one
+    int id;
+    if (!free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+        circle_events[id] = event;
+    } else {
+        id = circle_events.size();
+        circle_events.push_back(event);
+        heap_pos.push_back(kNone);
+    }
+
+    heap_pos[id] = heap.size();
+    heap.push_back(id);
+    SiftUp(heap.size() - 1);
+    return id;
+}
+
+void EventQueue::RemoveCircleEvent(int id) {
+    assert(heap_pos[id] != kNone);
+    RemoveAt(heap_pos[id]);
+    free_ids.push_back(id);
+}
+
+bool EventQueue::Before(int a, int b) const { return circle_events[b] < circle_events[a]; }
+
+void EventQueue::Swap(int i, int j) {
+    std::swap(heap[i], heap[j]);
+    heap_pos[heap[i]] = i;
+    heap_pos[heap[j]] = j;
+}
+
+void EventQueue::SiftUp(int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!Before(heap[i], heap[parent])) break;
+        Swap(i, parent);
+        i = parent;
+    }
+}
+
+void EventQueue::SiftDown(int i) {
+    int sz = heap.size();
+    while (true) {
+        int best = i;
+        int left = 2 * i + 1, right = 2 * i + 2;
+        if (left < sz && Before(heap[left], heap[best])) best = left;
+        if (right < sz && Before(heap[right], heap[best])) best = right;
+        if (best == i) break;
+        Swap(i, best);
+        i = best;
+    }
+}
+
+void EventQueue::RemoveAt(int i) {
+    // Move the last element into the hole and restore the heap in whichever direction is needed
+    int last = heap.size() - 1;
+    heap_pos[heap[i]] = kNone;
+    if (i != last) {
+        heap[i] = heap[last];
+        heap_pos[heap[i]] = i;
+    }
+    heap.pop_back();
+    if (i < static_cast<int>(heap.size())) {
+        SiftUp(i);
+        SiftDown(i);
+    }
+}
@@ -1,5 +1,5 @@
 #pragma once
-#include "beach_line.h"
+#include <vector>
 #include "geometry.h"
 
 class LeafNode;
@@ -24,18 +24,16 @@ class Event {
 
 class CircleEvent : public Event {
    public:
+    CircleEvent();
     CircleEvent(double y, geometry::Point center, LeafNode* arc);
 
     LeafNode* GetArc() const { return arc; }
     geometry::Point GetCenter() const { return center; }
     void SetArc(LeafNode* arc) { this->arc = arc; }
-    void SetFalseAlarm(bool false_alarm) { this->false_alarm = false_alarm; }
-    bool GetFalseAlarm() const { return false_alarm; }
 
    private:
     geometry::Point center;
     LeafNode* arc;
-    bool false_alarm;
 };
 
 class SiteEvent : public Event {
@@ -46,3 +44,50 @@ class SiteEvent : public Event {
    private:
     int site;
 };
+
+// Events ordered by decreasing y, without per-event allocations
+// Site events are known upfront and sorted once, circle events live in an indexed
+// heap over a pool so that they can be removed as soon as they become stale
+class EventQueue {
+   public:
+    static const int kNone = -1;
+
+    // Sorts all site events, unless the sites are known to be sorted in the order of the sweep
+    void Init(const std::vector<geometry::Point>& sites, bool sorted = false);
+
+    bool Empty() const;
+
+    // Peeks at the next event
+    char NextType() const;
+    double NextY() const;
+
+    // Pops the next event, the type has to match
+    SiteEvent PopSiteEvent();
+    CircleEvent PopCircleEvent();
+
+    // Adds a circle event and returns its id
+    int AddCircleEvent(const CircleEvent& event);
+
+    // Removes a circle event that has not been popped yet
+    void RemoveCircleEvent(int id);
+
+   private:
+    // Is circle event a before circle event b in the sweep?
+    bool Before(int a, int b) const;
+
+    // Indexed heap helpers
+    void Swap(int i, int j);
+    void SiftUp(int i);
+    void SiftDown(int i);
+    void RemoveAt(int i);
+
+    // Site events in sweep order and the next one to pop
+    std::vector<SiteEvent> site_events;
+    int next_site = 0;
+
+    // Circle event pool, ids of free slots and positions of the ids in the heap
+    std::vector<CircleEvent> circle_events;
+    std::vector<int> free_ids;
+    std::vector<int> heap_pos;
+    std::vector<int> heap;  // Max-heap of ids, the first event in the sweep is on top
+};
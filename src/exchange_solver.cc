@@ -0,0 +1,192 @@
+#include "exchange_solver.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+// Steps before giving up, a ring usually needs a handful
+const int kMaxIterations = 64;
+
+// Points this far outside the annulus, relative to its size, are rounding errors
+const double kTolerance = 1e-12;
+
+// Only thin rings are trusted, on thicker inputs a local optimum can be far from the best one
+const double kMaxRelativeWidth = 0.1;
+
+}  // namespace
+
+ExchangeSolver::ExchangeSolver(const std::vector<geometry::Point>& points) : points(points), evaluator(points) {}
+
+bool ExchangeSolver::Solve(geometry::Annulus* ann) {
+    iterations = 0;
+    if (points.size() < 4) return false;
+    geometry::Point center;
+    if (!LeastSquaresCenter(&center) || !InitialCritical(center)) return false;
+    return Iterate(ann);
+}
+
+bool ExchangeSolver::Solve(geometry::Annulus* ann, const Critical& start) {
+    iterations = 0;
+    int n = points.size();
+    int slots[4] = {start.outer[0], start.outer[1], start.inner[0], start.inner[1]};
+    for (int i = 0; i < 4; i++) {
+        if (slots[i] < 0 || slots[i] >= n) return false;
+        for (int j = 0; j < i; j++) {
+            if (slots[i] == slots[j]) return false;
+        }
+    }
+    outer[0] = start.outer[0];
+    outer[1] = start.outer[1];
+    inner[0] = start.inner[0];
+    inner[1] = start.inner[1];
+    return Iterate(ann);
+}
+
+ExchangeSolver::Critical ExchangeSolver::GetCritical() const {
+    return {{outer[0], outer[1]}, {inner[0], inner[1]}};
+}
+
+bool ExchangeSolver::Iterate(geometry::Annulus* ann) {
+    geometry::Point center;
+
+    // A configuration that comes back means the exchange is going around in circles
+    std::vector<std::array<int, 4>> seen;
+    while (iterations < kMaxIterations) {
+        iterations++;
+        std::array<int, 4> config = {std::min(outer[0], outer[1]), std::max(outer[0], outer[1]),
+                                     std::min(inner[0], inner[1]), std::max(inner[0], inner[1])};
+        if (std::find(seen.begin(), seen.end(), config) != seen.end()) return false;
+        seen.push_back(config);
+
+        // The center is equally far from both outer and both inner points
+        geometry::Line outer_bis = geometry::Bisector(points[outer[0]], points[outer[1]]);
+        geometry::Line inner_bis = geometry::Bisector(points[inner[0]], points[inner[1]]);
+        if (geometry::ParallelLines(inner_bis, outer_bis)) return false;
+        center = geometry::LineIntersection(inner_bis, outer_bis);
+        double r_outer = geometry::Dist(center, points[outer[0]]);
+        double r_inner = geometry::Dist(center, points[inner[0]]);
+
+        // Find the point farthest outside the annulus, on either side
+        int min_idx, max_idx;
+        double min_sq, max_sq;
+        evaluator.ArgMinMaxSquaredDist(center, &min_idx, &max_idx, &min_sq, &max_sq);
+        double tol = kTolerance * r_outer;
+        double outer_excess = std::sqrt(max_sq) - r_outer;
+        double inner_excess = r_inner - std::sqrt(min_sq);
+        if (outer_excess <= tol && inner_excess <= tol) {
+            if (!Alternating(center)) return false;
+            if (std::sqrt(max_sq) - std::sqrt(min_sq) > kMaxRelativeWidth * std::sqrt(max_sq)) return false;
+            ann->center = center;
+            ann->r_inner = std::sqrt(min_sq);
+            ann->r_outer = std::sqrt(max_sq);
+            return true;
+        }
+        bool swap_outer = outer_excess >= inner_excess;
+        if (!Exchange(center, swap_outer ? max_idx : min_idx, swap_outer)) return false;
+    }
+    return false;
+}
+
+bool ExchangeSolver::LeastSquaresCenter(geometry::Point* center) {
+    // Relative to the centroid, the normal equations reduce to a 2x2 system
+    int n = points.size();
+    double mean_x = 0, mean_y = 0;
+    for (const geometry::Point& pt : points) {
+        mean_x += pt.x / n;
+        mean_y += pt.y / n;
+    }
+    double suu = 0, suv = 0, svv = 0, suuu = 0, svvv = 0, suvv = 0, svuu = 0;
+    for (const geometry::Point& pt : points) {
+        double u = pt.x - mean_x, v = pt.y - mean_y;
+        suu += u * u;
+        suv += u * v;
+        svv += v * v;
+        suuu += u * u * u;
+        svvv += v * v * v;
+        suvv += u * v * v;
+        svuu += v * u * u;
+    }
+    double det = suu * svv - suv * suv;
+    if (det <= 1e-12 * (suu * svv)) return false;
+    double rhs_u = (suuu + suvv) / 2, rhs_v = (svvv + svuu) / 2;
+    center->x = mean_x + (rhs_u * svv - rhs_v * suv) / det;
+    center->y = mean_y + (rhs_v * suu - rhs_u * suv) / det;
+    center->idx = 0;
+    return true;
+}
+
+bool ExchangeSolver::InitialCritical(geometry::Point center) {
+    int min_idx, max_idx;
+    double min_sq, max_sq;
+    evaluator.ArgMinMaxSquaredDist(center, &min_idx, &max_idx, &min_sq, &max_sq);
+
+    // Quadrants start half a quadrant before the farthest point, which is the farthest of the first one
+    double start = geometry::PseudoAngle(points[max_idx].x - center.x, points[max_idx].y - center.y);
+    int best[4] = {max_idx, -1, -1, -1};
+    double best_sq[4] = {max_sq, 0, 0, 0};
+    int n = points.size();
+    for (int i = 0; i < n; i++) {
+        double dx = points[i].x - center.x, dy = points[i].y - center.y;
+        double angle = geometry::PseudoAngle(dx, dy) - start;
+        if (angle < 0) angle += 4;
+        int quadrant = static_cast<int>(angle + 0.5) % 4;
+        if (quadrant == 0) continue;
+        double d = dx * dx + dy * dy;
+        bool better = (quadrant == 2) ? d > best_sq[quadrant] : d < best_sq[quadrant];
+        if (best[quadrant] == -1 || better) {
+            best[quadrant] = i;
+            best_sq[quadrant] = d;
+        }
+    }
+    if (best[1] == -1 || best[2] == -1 || best[3] == -1) return false;
+    outer[0] = best[0];
+    inner[0] = best[1];
+    outer[1] = best[2];
+    inner[1] = best[3];
+    return true;
+}
+
+bool ExchangeSolver::Exchange(geometry::Point center, int idx, bool outer_side) {
+    if (idx == outer[0] || idx == outer[1] || idx == inner[0] || idx == inner[1]) return false;
+
+    // Critical points by angle around the center, with a pointer to their slot
+    struct Critical {
+        double angle;
+        bool outer;
+        int* slot;
+    };
+    std::array<Critical, 4> crit = {{{0, true, &outer[0]}, {0, false, &inner[0]}, {0, true, &outer[1]},
+                                     {0, false, &inner[1]}}};
+    for (Critical& c : crit) {
+        c.angle = std::atan2(points[*c.slot].y - center.y, points[*c.slot].x - center.x);
+    }
+    std::sort(crit.begin(), crit.end(), [](const Critical& a, const Critical& b) { return a.angle < b.angle; });
+    for (int k = 0; k < 4; k++) {
+        if (crit[k].outer == crit[(k + 1) % 4].outer) return false;
+    }
+
+    // The new point falls between two neighbours, one of each kind, and takes the place of the one of its kind
+    double angle = std::atan2(points[idx].y - center.y, points[idx].x - center.x);
+    int k = 3;
+    for (int i = 0; i < 4; i++) {
+        if (crit[i].angle <= angle) k = i;
+    }
+    Critical& replaced = (crit[k].outer == outer_side) ? crit[k] : crit[(k + 1) % 4];
+    *replaced.slot = idx;
+    return true;
+}
+
+bool ExchangeSolver::Alternating(geometry::Point center) {
+    std::array<std::pair<double, bool>, 4> crit;
+    int slots[4] = {outer[0], inner[0], outer[1], inner[1]};
+    for (int i = 0; i < 4; i++) {
+        crit[i] = {std::atan2(points[slots[i]].y - center.y, points[slots[i]].x - center.x), i % 2 == 0};
+    }
+    std::sort(crit.begin(), crit.end());
+    for (int k = 0; k < 4; k++) {
+        if (crit[k].second == crit[(k + 1) % 4].second) return false;
+    }
+    return true;
+}
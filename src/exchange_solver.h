@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include "geometry.h"
+#include "width_evaluator.h"
+
+// Finds the smallest-width annulus of a nearly circular input without building any diagram
+// Keeps two outer and two inner critical points that alternate around the center, which is where the
+// bisector of the outer pair meets the bisector of the inner pair. Every step scans all points for the one
+// farthest outside the annulus and swaps it for the critical point of its kind that keeps the alternation.
+// With no point outside and the critical points alternating the annulus is a local optimum (the
+// minimum-zone criterion). The problem is close to linear for a thin ring, so there it is the optimum
+// It starts from the least-squares circle and gives up on inputs that don't behave like a thin ring: a
+// width over a tenth of the radius, an optimum held by three points on one circle, parallel bisectors or
+// too many steps
+class ExchangeSolver {
+   public:
+    // The points are not copied, they have to outlive the solver
+    ExchangeSolver(const std::vector<geometry::Point>& points);
+
+    // Critical points, as positions in the points
+    struct Critical {
+        int outer[2], inner[2];
+    };
+
+    // Returns false if it gave up, 'ann' is only set on success
+    bool Solve(geometry::Annulus* ann);
+
+    // Starts from the critical points of an earlier solve instead of the least-squares circle, for points
+    // that moved a little since (e.g. the same part measured again). If they still hold the optimum it
+    // takes a single scan, otherwise it goes on from there. Also false if 'start' isn't a valid start
+    bool Solve(geometry::Annulus* ann, const Critical& start);
+
+    // Critical points of the last successful solve
+    Critical GetCritical() const;
+
+    // Steps of the last solve
+    int GetIterations() const { return iterations; }
+
+   private:
+    // Exchanges from the current critical points on
+    bool Iterate(geometry::Annulus* ann);
+
+    // Center of the least-squares (Kasa) circle, false if all points are on a line
+    bool LeastSquaresCenter(geometry::Point* center);
+
+    // The first critical points: the farthest point and, going around the center from it, the nearest,
+    // farthest and nearest point of the next three quadrants
+    bool InitialCritical(geometry::Point center);
+
+    // Swaps a point outside the annulus around 'center' in for a critical point of its kind, so that the
+    // critical points still alternate. False if they didn't alternate in the first place
+    bool Exchange(geometry::Point center, int idx, bool outer_side);
+
+    // Checks if the critical points alternate between outer and inner around 'center'
+    bool Alternating(geometry::Point center);
+
+    const std::vector<geometry::Point>& points;
+    WidthEvaluator evaluator;
+    int outer[2], inner[2];
+    int iterations = 0;
+};
@@ -1,14 +1,17 @@
 #include "fp_voronoi.h"
 #include "voronoi_utils.h"
 
+#include <algorithm>
+
 FarthestPointVoronoi::FarthestPointVoronoi(Model* model) {
     this->model = model;
     sites = model->GetPoints();
     dcel = model->GetFpVoronoiDcel();
+    rng.seed(model->GetSeed());
 }
 
-std::future<void> FarthestPointVoronoi::ComputeDiagram() {
-    return std::async(std::launch::async, &FarthestPointVoronoi::Incremental, this);
+std::future<void> FarthestPointVoronoi::ComputeDiagram(std::launch policy) {
+    return std::async(policy, &FarthestPointVoronoi::Incremental, this);
 }
 
 void FarthestPointVoronoi::ProcessAllCollinear() {
@@ -46,64 +49,59 @@ void FarthestPointVoronoi::ProcessAllCollinear() {
     {
         std::lock_guard<std::mutex> lock(*(model->GetMutex()));
 
-        dcel->faces.push_back(new Dcel::Face(0));  // min
-        dcel->faces.push_back(new Dcel::Face(1));  // max
-        open_face = new Dcel::Face(2);
-        dcel->faces.push_back(open_face);  // outer
+        dcel->AddFace(0);              // min
+        dcel->AddFace(1);              // max
+        open_face = dcel->AddFace(2);  // outer
         geometry::Point mid = geometry::Midpoint(min, max);
-        Dcel::Vertex* v = new Dcel::Vertex(mid);
-        dcel->vertices.push_back(v);
-        Dcel::HalfEdge* upper_up = new Dcel::HalfEdge();
-        Dcel::HalfEdge* upper_down = new Dcel::HalfEdge();
-        Dcel::HalfEdge* lower_up = new Dcel::HalfEdge();
-        Dcel::HalfEdge* lower_down = new Dcel::HalfEdge();
-        dcel->half_edges.push_back(upper_up);
-        dcel->half_edges.push_back(upper_down);
-        dcel->half_edges.push_back(lower_up);
-        dcel->half_edges.push_back(lower_down);
+        int v = dcel->AddVertex(mid);
+        std::pair<int, int> upper = dcel->AddEdge();
+        std::pair<int, int> lower = dcel->AddEdge();
+        int upper_up = upper.first, upper_down = upper.second;
+        int lower_up = lower.first, lower_down = lower.second;
+        std::vector<Dcel::HalfEdge>& he = dcel->half_edges;
 
         // Set origins
-        upper_up->origin = v;
-        lower_down->origin = v;
+        he[upper_up].origin = v;
+        he[lower_down].origin = v;
 
-        // Set twins/prev/next
-        v->incident_halfedge = upper_up;
-        upper_up->twin = upper_down, upper_down->twin = upper_up;
-        lower_up->twin = lower_down, lower_down->twin = lower_up;
-        lower_up->next = upper_up, upper_up->prev = lower_up;
-        upper_down->next = lower_down, lower_down->prev = upper_down;
+        // Set prev/next, twins are already set
+        dcel->vertices[v].incident_halfedge = upper_up;
+        he[lower_up].next = upper_up, he[upper_up].prev = lower_up;
+        he[upper_down].next = lower_down, he[lower_down].prev = upper_down;
 
         // Set incident faces
-        upper_up->incident_face = dcel->faces[1];
-        lower_up->incident_face = dcel->faces[1];
-        upper_down->incident_face = dcel->faces[0];
-        lower_down->incident_face = dcel->faces[0];
+        he[upper_up].incident_face = 1;
+        he[lower_up].incident_face = 1;
+        he[upper_down].incident_face = 0;
+        he[lower_down].incident_face = 0;
 
         // Add a line
         geometry::Line bis = geometry::Bisector(min, max);
         if (bis.vertical) {
             bis.dir = 'u';
-            upper_up->line = bis;
-            upper_down->line = bis;
+            he[upper_up].line = bis;
+            he[upper_down].line = bis;
             bis.dir = 'd';
-            lower_up->line = bis;
-            lower_down->line = bis;
+            he[lower_up].line = bis;
+            he[lower_down].line = bis;
         } else {
             char fst = (min.y < max.y) ? 'l' : 'r';
             char snd = (fst == 'l') ? 'r' : 'l';
             bis.dir = fst;
-            upper_up->line = bis;
-            upper_down->line = bis;
+            he[upper_up].line = bis;
+            he[upper_down].line = bis;
             bis.dir = snd;
-            lower_up->line = bis;
-            lower_down->line = bis;
+            he[lower_up].line = bis;
+            he[lower_down].line = bis;
         }
     }
 }
 
 void FarthestPointVoronoi::ProcessRegular() {
     // Counterclockwise
+    auto hull_start = std::chrono::steady_clock::now();
     hull = geometry::GrahamScanConvexHull(sites);
+    model->GetStageTimes()->hull = SecondsSince(hull_start);
     int hsz = hull.size();
     struct Node {
         int idx, idx_cw, idx_ccw;
@@ -120,8 +118,9 @@ void FarthestPointVoronoi::ProcessRegular() {
 
     model->SetHull(hull);
     // Shuffle the hull and fill inv map
-    std::random_shuffle(hull.begin(), hull.end());
+    std::shuffle(hull.begin(), hull.end(), rng);
     inv.resize(hull.size());
+    first_edge.assign(hull.size(), Dcel::kNone);
     for (int i = 0; i < hsz; i++) {
         inv[hull[i].idx] = i;
     }
@@ -137,10 +136,9 @@ void FarthestPointVoronoi::ProcessRegular() {
     {
         std::lock_guard<std::mutex> lock(*(model->GetMutex()));
         for (int i = 0; i < hsz; i++) {
-            dcel->faces.push_back(new Dcel::Face(i));
+            dcel->AddFace(i);
         }
-        open_face = new Dcel::Face(hsz);
-        dcel->faces.push_back(open_face);  // outer face
+        open_face = dcel->AddFace(hsz);  // outer face
     }
 
     // Compute initial solution and add points one-by-one
@@ -150,72 +148,73 @@ void FarthestPointVoronoi::ProcessRegular() {
             std::lock_guard<std::mutex> lock(*(model->GetMutex()));
             AddPoint(hull, hull[i]);
         }
-        Prune();  // Delete pruned vertices/half-edges
-        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        Prune();  // Tombstone pruned vertices/half-edges
+        model->GetFpVoronoiPacer()->Step();
+    }
+
+    // Drop the tombstones, once
+    {
+        std::lock_guard<std::mutex> lock(*(model->GetMutex()));
+        std::vector<int> edge_remap = dcel->Compact();
+        for (int& he : first_edge) {
+            if (he != Dcel::kNone) he = edge_remap[he];
+        }
     }
 }
 
 void FarthestPointVoronoi::Incremental() {
+    auto start = std::chrono::steady_clock::now();
+    StageTimes* times = model->GetStageTimes();
+
     // Incremental algorithm
-    if (geometry::AllCollinear(sites)) {
+    const geometry::PointSetInfo& info = model->GetPointSetInfo();
+    if (geometry::AllCollinear(sites, info)) {
         ProcessAllCollinear();
     } else {
         ProcessRegular();
     }
 
     // Add bounding box around
-    Dcel::HalfEdge* open_edge;
     {
         std::lock_guard<std::mutex> lock(*(model->GetMutex()));
-        open_edge = voronoi_utils::AddBox(sites, open_face, dcel);
+        auto box_start = std::chrono::steady_clock::now();
+        int open_edge = voronoi_utils::AddBox(sites, open_face, dcel, info.has_box ? &info.box : nullptr);
+        times->fp_voronoi_box = SecondsSince(box_start);
 
         // Fix outer/inner component pointers
-        for (Dcel::HalfEdge* he : dcel->half_edges) {
-            Dcel::Face* face = he->incident_face;
-            if (face != open_face && face->outer_component == nullptr) {
-                face->outer_component = open_edge;
-                open_face->inner_components.push_back(he);
+        int he_sz = dcel->half_edges.size();
+        for (int he = 0; he < he_sz; he++) {
+            Dcel::Face& face = dcel->faces[dcel->half_edges[he].incident_face];
+            if (dcel->half_edges[he].incident_face != open_face && face.outer_component == Dcel::kNone) {
+                face.outer_component = open_edge;
+                dcel->faces[open_face].inner_components.push_back(he);
             }
         }
     }
-    printf("Farthest-point Voronoi diagram found!\n");
+    times->fp_incremental = SecondsSince(start) - times->hull - times->fp_voronoi_box;
+    if (model->GetVisualize()) printf("Farthest-point Voronoi diagram found!\n");
 }
 
 void FarthestPointVoronoi::Prune() {
     {
+        // References to tombstoned elements read as kNone from now on
         std::lock_guard<std::mutex> lock(*(model->GetMutex()));
-
-        // Prune edges
-        std::vector<Dcel::HalfEdge*> new_edges;
-        for (auto he : dcel->half_edges) {
-            if (edges_pruned.find(he) == edges_pruned.end()) {
-                new_edges.push_back(he);
-            }
-        }
-        dcel->half_edges = new_edges;
-        for (auto he : edges_pruned) delete he;
-        edges_pruned.clear();
-
-        // Prune vertices
-        std::vector<Dcel::Vertex*> new_verts;
-        for (auto v : dcel->vertices) {
-            if (vertices_pruned.find(v) == vertices_pruned.end()) {
-                new_verts.push_back(v);
-            }
-        }
-        dcel->vertices = new_verts;
-        for (auto v : vertices_pruned) delete v;
+        for (int v : vertices_pruned) dcel->vertices[v].removed = true;
+        for (int he : edges_pruned) dcel->half_edges[he].removed = true;
         vertices_pruned.clear();
+        edges_pruned.clear();
     }
 }
 
 void FarthestPointVoronoi::AddPoint(const std::vector<geometry::Point>& hull, geometry::Point pt) {
     // Core logic: add a new point to the diagram
+    // Note: 'he' is refreshed after adding new half-edges since that can move the array
+    std::vector<Dcel::HalfEdge>* he = &dcel->half_edges;
 
-    Dcel::HalfEdge* curr = first_edge[ccw[pt.idx]];
-    Dcel::HalfEdge *last_pt_fwd, *last_opt_fwd, *last_opt_bwd, *last_pt_bwd;
-    last_pt_fwd = last_opt_bwd = last_opt_fwd = last_pt_bwd = nullptr;
-    Dcel::Vertex* last_vertex = nullptr;
+    int curr = first_edge[ccw[pt.idx]];
+    int last_pt_fwd, last_opt_fwd, last_opt_bwd, last_pt_bwd;
+    last_pt_fwd = last_opt_bwd = last_opt_fwd = last_pt_bwd = Dcel::kNone;
+    int last_vertex = Dcel::kNone;
     geometry::Point opt;
 
     geometry::Point inter;
@@ -226,58 +225,59 @@ void FarthestPointVoronoi::AddPoint(const std::vector<geometry::Point>& hull, ge
         do {
             // Walk around one face until there is an intersection
             if (!edges_pruned.empty()) {
-                if (curr->next == nullptr) {
+                if (dcel->Next(curr) == Dcel::kNone) {
                     done = true;
                     break;
                 }
-                curr = curr->next;
+                curr = dcel->Next(curr);
             }
 
             // Prune
-            if (curr->origin != nullptr) {
-                vertices_pruned.insert(curr->origin);
+            int curr_twin = dcel->Twin(curr);
+            if (dcel->Origin(curr) != Dcel::kNone) {
+                vertices_pruned.push_back(dcel->Origin(curr));
             }
-            edges_pruned.insert(curr);
-            edges_pruned.insert(curr->twin);
-            opt = hull[inv[curr->incident_face->site]];  // also ccw[pt.idx]
+            edges_pruned.push_back(curr);
+            edges_pruned.push_back(curr_twin);
+            opt = hull[inv[dcel->Site(curr)]];  // also ccw[pt.idx]
             geometry::Line bis = geometry::Bisector(pt, opt);
-            inter = geometry::LineIntersection(curr->line, bis);
-            if (!curr->origin || !curr->twin->origin) {
+            inter = geometry::LineIntersection((*he)[curr].line, bis);
+            if (dcel->Origin(curr) == Dcel::kNone || dcel->Origin(curr_twin) == Dcel::kNone) {
                 // Half infinite
-                geometry::Point orig = (curr->origin) ? curr->origin->point : curr->twin->origin->point;
-                has_intersection = geometry::CheckHalflineSide(inter, curr->line, orig);
+                geometry::Point orig =
+                    (dcel->Origin(curr) != Dcel::kNone) ? dcel->OriginPoint(curr) : dcel->OriginPoint(curr_twin);
+                has_intersection = geometry::CheckHalflineSide(inter, (*he)[curr].line, orig);
             } else {
                 // Regular
-                has_intersection = geometry::CheckOrder(curr->origin->point, inter, curr->twin->origin->point);
+                has_intersection = geometry::CheckOrder(dcel->OriginPoint(curr), inter, dcel->OriginPoint(curr_twin));
             }
         } while (!has_intersection);
+        int curr_twin = dcel->Twin(curr);
         if (done) {
             // This is the last iteration, finish the rewiring
             geometry::Point L;
-            if (curr->origin != nullptr)
-                L = curr->origin->point;
+            if (dcel->Origin(curr) != Dcel::kNone)
+                L = dcel->OriginPoint(curr);
             else
-                L = curr->twin->line.ForwardPoint(curr->twin->origin->point);
+                L = (*he)[curr_twin].line.ForwardPoint(dcel->OriginPoint(curr_twin));
             geometry::Point R;
-            if (curr->twin->origin != nullptr)
-                R = curr->twin->origin->point;
+            if (dcel->Origin(curr_twin) != Dcel::kNone)
+                R = dcel->OriginPoint(curr_twin);
             else
-                R = curr->line.ForwardPoint(curr->origin->point);
+                R = (*he)[curr].line.ForwardPoint(dcel->OriginPoint(curr));
 
             opt = hull[inv[cw[pt.idx]]];  // also ccw[pt.idx]
 
             // Add new edges
-            Dcel::HalfEdge* pt_fwd = new Dcel::HalfEdge();
+            std::pair<int, int> pt_edge = dcel->AddEdge();
+            he = &dcel->half_edges;
+            int pt_fwd = pt_edge.first, pt_bwd = pt_edge.second;
             first_edge[pt.idx] = pt_fwd;
-            Dcel::HalfEdge* pt_bwd = new Dcel::HalfEdge();
 
-            // Add pointers
-            dcel->half_edges.push_back(pt_fwd);
-            dcel->half_edges.push_back(pt_bwd);
-            pt_bwd->origin = last_vertex;
-            pt_fwd->twin = pt_bwd, pt_bwd->twin = pt_fwd;
-            pt_fwd->incident_face = dcel->faces[pt.idx];
-            pt_bwd->incident_face = dcel->faces[opt.idx];
+            // Add pointers, twins are already set
+            (*he)[pt_bwd].origin = last_vertex;
+            (*he)[pt_fwd].incident_face = pt.idx;
+            (*he)[pt_bwd].incident_face = opt.idx;
 
             // Add a line
             geometry::Line bis = geometry::Bisector(pt, opt);
@@ -294,62 +294,55 @@ void FarthestPointVoronoi::AddPoint(const std::vector<geometry::Point>& hull, ge
                     bis.dir = 'r';
                 }
             }
-            pt_fwd->line = pt_bwd->line = bis;
+            (*he)[pt_fwd].line = (*he)[pt_bwd].line = bis;
 
             // Set next and prev
-            pt_bwd->next = nullptr;
-            pt_bwd->prev = last_opt_bwd;
-            if (last_opt_bwd != nullptr) last_opt_bwd->next = pt_bwd;
+            (*he)[pt_bwd].next = Dcel::kNone;
+            (*he)[pt_bwd].prev = last_opt_bwd;
+            if (last_opt_bwd != Dcel::kNone) (*he)[last_opt_bwd].next = pt_bwd;
 
-            pt_fwd->next = last_pt_fwd;
-            if (last_pt_fwd != nullptr) last_pt_fwd->prev = pt_fwd;
-            pt_fwd->prev = nullptr;
+            (*he)[pt_fwd].next = last_pt_fwd;
+            if (last_pt_fwd != Dcel::kNone) (*he)[last_pt_fwd].prev = pt_fwd;
+            (*he)[pt_fwd].prev = Dcel::kNone;
             break;
         }
 
         // Add 1 vertex and 4 edges
         geometry::Point L;
-        if (curr->origin != nullptr)
-            L = curr->origin->point;
+        if (dcel->Origin(curr) != Dcel::kNone)
+            L = dcel->OriginPoint(curr);
         else
-            L = curr->twin->line.ForwardPoint(curr->twin->origin->point);
+            L = (*he)[curr_twin].line.ForwardPoint(dcel->OriginPoint(curr_twin));
         geometry::Point R;
-        if (curr->twin->origin != nullptr)
-            R = curr->twin->origin->point;
+        if (dcel->Origin(curr_twin) != Dcel::kNone)
+            R = dcel->OriginPoint(curr_twin);
         else
-            R = curr->line.ForwardPoint(curr->origin->point);
-
-        Dcel::Vertex* vertex = new Dcel::Vertex(inter);
-        Dcel::HalfEdge* opt_fwd = new Dcel::HalfEdge();
-        Dcel::HalfEdge* opt_bwd = new Dcel::HalfEdge();
-        Dcel::HalfEdge* pt_fwd = new Dcel::HalfEdge();
-        Dcel::HalfEdge* pt_bwd = new Dcel::HalfEdge();
-
-        // Set pointers
-        if (curr->twin->origin != nullptr) {
-            curr->twin->origin->incident_halfedge = opt_bwd;
+            R = (*he)[curr].line.ForwardPoint(dcel->OriginPoint(curr));
+
+        int vertex = dcel->AddVertex(inter);
+        std::pair<int, int> opt_edge = dcel->AddEdge();
+        std::pair<int, int> pt_edge = dcel->AddEdge();
+        he = &dcel->half_edges;
+        int opt_fwd = opt_edge.first, opt_bwd = opt_edge.second;
+        int pt_fwd = pt_edge.first, pt_bwd = pt_edge.second;
+
+        // Set pointers, twins are already set
+        int curr_twin_origin = dcel->Origin(curr_twin);
+        if (curr_twin_origin != Dcel::kNone) {
+            dcel->vertices[curr_twin_origin].incident_halfedge = opt_bwd;
         }
 
-        dcel->vertices.push_back(vertex);
-        dcel->half_edges.push_back(pt_fwd);
-        dcel->half_edges.push_back(pt_bwd);
-        dcel->half_edges.push_back(opt_fwd);
-        dcel->half_edges.push_back(opt_bwd);
-
-        vertex->incident_halfedge = pt_fwd;
-        pt_fwd->origin = opt_fwd->origin = vertex;
-        opt_bwd->origin = curr->twin->origin;  // maybe nullptr
-        pt_bwd->origin = last_vertex;
-
-        opt_fwd->twin = opt_bwd, opt_bwd->twin = opt_fwd;
-        pt_fwd->twin = pt_bwd, pt_bwd->twin = pt_fwd;
+        dcel->vertices[vertex].incident_halfedge = pt_fwd;
+        (*he)[pt_fwd].origin = (*he)[opt_fwd].origin = vertex;
+        (*he)[opt_bwd].origin = curr_twin_origin;  // maybe kNone
+        (*he)[pt_bwd].origin = last_vertex;
 
-        pt_fwd->incident_face = dcel->faces[pt.idx];
-        pt_bwd->incident_face = opt_fwd->incident_face = dcel->faces[opt.idx];
-        opt_bwd->incident_face = dcel->faces[curr->twin->incident_face->site];
+        (*he)[pt_fwd].incident_face = pt.idx;
+        (*he)[pt_bwd].incident_face = (*he)[opt_fwd].incident_face = opt.idx;
+        (*he)[opt_bwd].incident_face = dcel->Site(curr_twin);
 
         // Add a line
-        opt_bwd->line = opt_fwd->line = curr->line;
+        (*he)[opt_bwd].line = (*he)[opt_fwd].line = (*he)[curr].line;
 
         // Bisector line
         geometry::Line bis = geometry::Bisector(pt, opt);
@@ -366,33 +359,35 @@ void FarthestPointVoronoi::AddPoint(const std::vector<geometry::Point>& hull, ge
                 bis.dir = 'r';
             }
         }
-        pt_fwd->line = pt_bwd->line = bis;
+        (*he)[pt_fwd].line = (*he)[pt_bwd].line = bis;
 
         // Set next and prev
-        pt_bwd->next = opt_fwd;
-        opt_fwd->prev = pt_bwd;
+        (*he)[pt_bwd].next = opt_fwd;
+        (*he)[opt_fwd].prev = pt_bwd;
 
-        pt_bwd->prev = last_opt_bwd;
-        if (last_opt_bwd != nullptr) last_opt_bwd->next = pt_bwd;
+        (*he)[pt_bwd].prev = last_opt_bwd;
+        if (last_opt_bwd != Dcel::kNone) (*he)[last_opt_bwd].next = pt_bwd;
 
-        opt_fwd->next = curr->next;
-        if (curr->next != nullptr) curr->next->prev = opt_fwd;
+        int curr_next = dcel->Next(curr);
+        (*he)[opt_fwd].next = curr_next;
+        if (curr_next != Dcel::kNone) (*he)[curr_next].prev = opt_fwd;
 
         // prev taken care of
-        pt_fwd->next = last_pt_fwd;
-        if (last_pt_fwd != nullptr) last_pt_fwd->prev = pt_fwd;
+        (*he)[pt_fwd].next = last_pt_fwd;
+        if (last_pt_fwd != Dcel::kNone) (*he)[last_pt_fwd].prev = pt_fwd;
 
         // pt_fwd->prev will be set later
         // opt_bwd->next will be set later
-        opt_bwd->prev = curr->twin->prev;
-        if (curr->twin->prev != nullptr) curr->twin->prev->next = opt_bwd;
+        int curr_twin_prev = dcel->Prev(curr_twin);
+        (*he)[opt_bwd].prev = curr_twin_prev;
+        if (curr_twin_prev != Dcel::kNone) (*he)[curr_twin_prev].next = opt_bwd;
 
         // first pt_bwd is definitely a first edge for ccw[pt]=opt
-        if (last_pt_bwd == nullptr) first_edge[opt.idx] = pt_bwd;
+        if (last_pt_bwd == Dcel::kNone) first_edge[opt.idx] = pt_bwd;
 
         // every opt bwd is a first for someone if it has no origin
-        if (opt_bwd->origin == nullptr) {
-            int idx = opt_bwd->incident_face->site;
+        if ((*he)[opt_bwd].origin == Dcel::kNone) {
+            int idx = dcel->Site(opt_bwd);
             first_edge[idx] = opt_bwd;
         }
 
@@ -402,7 +397,7 @@ void FarthestPointVoronoi::AddPoint(const std::vector<geometry::Point>& hull, ge
         last_opt_bwd = opt_bwd;
         last_pt_bwd = pt_bwd;
         last_vertex = vertex;
-        curr = curr->twin;
+        curr = curr_twin;
     }
 }
 
@@ -422,22 +417,17 @@ void FarthestPointVoronoi::OrientBis(geometry::Line* bis, geometry::Point a, geo
     }
 }
 
-std::pair<Dcel::HalfEdge*, Dcel::HalfEdge*> FarthestPointVoronoi::AddHalfEdges(Dcel::Vertex* vertex,
-                                                                               const geometry::Line& bis, int fst,
-                                                                               int snd) {
-    Dcel::HalfEdge* out = new Dcel::HalfEdge();
-    Dcel::HalfEdge* in = new Dcel::HalfEdge();
-    out->line = bis;
-    in->line = bis;
-    out->origin = vertex;
-    out->twin = in;
-    in->twin = out;
-
-    out->incident_face = dcel->faces[fst];
-    in->incident_face = dcel->faces[snd];
-
-    dcel->half_edges.push_back(in);
-    dcel->half_edges.push_back(out);
+std::pair<int, int> FarthestPointVoronoi::AddHalfEdges(int vertex, const geometry::Line& bis, int fst, int snd) {
+    std::pair<int, int> edge = dcel->AddEdge();
+    int out = edge.first, in = edge.second;
+    Dcel::HalfEdge& out_edge = dcel->half_edges[out];
+    Dcel::HalfEdge& in_edge = dcel->half_edges[in];
+    out_edge.line = bis;
+    in_edge.line = bis;
+    out_edge.origin = vertex;
+
+    out_edge.incident_face = fst;
+    in_edge.incident_face = snd;
     return {in, out};
 }
 
@@ -458,10 +448,9 @@ void FarthestPointVoronoi::ComputeInitialSolution(geometry::Point a, geometry::P
     OrientBis(&ca_bis, c, a);
 
     // Fill DCEL
-    Dcel::Vertex* vertex = new Dcel::Vertex(center);
     {
         std::lock_guard<std::mutex> lock(*(model->GetMutex()));
-        dcel->vertices.push_back(vertex);
+        int vertex = dcel->AddVertex(center);
         auto ab = AddHalfEdges(vertex, ab_bis, a.idx, b.idx);
         auto bc = AddHalfEdges(vertex, bc_bis, b.idx, c.idx);
         auto ca = AddHalfEdges(vertex, ca_bis, c.idx, a.idx);
@@ -470,16 +459,17 @@ void FarthestPointVoronoi::ComputeInitialSolution(geometry::Point a, geometry::P
         first_edge[a.idx] = ca.first;
         first_edge[b.idx] = ab.first;
         first_edge[c.idx] = bc.first;
-        vertex->incident_halfedge = ab.second;
+        dcel->vertices[vertex].incident_halfedge = ab.second;
 
         // Set next/prev pointers
-        ab.first->next = bc.second;
-        bc.second->prev = ab.first;
+        std::vector<Dcel::HalfEdge>& he = dcel->half_edges;
+        he[ab.first].next = bc.second;
+        he[bc.second].prev = ab.first;
 
-        bc.first->next = ca.second;
-        ca.second->prev = bc.first;
+        he[bc.first].next = ca.second;
+        he[ca.second].prev = bc.first;
 
-        ca.first->next = ab.second;
-        ab.second->prev = ca.first;
+        he[ca.first].next = ab.second;
+        he[ab.second].prev = ca.first;
     }
 }
\ No newline at end of file
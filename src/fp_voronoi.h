@@ -1,6 +1,5 @@
 #pragma once
-#include <map>
-#include <set>
+#include <random>
 #include <vector>
 #include "dcel.h"
 #include "geometry.h"
@@ -10,8 +9,8 @@ class FarthestPointVoronoi {
    public:
     FarthestPointVoronoi(Model* model);
 
-    // Find the farthest-point Voronoi diagram in a new thread
-    std::future<void> ComputeDiagram();
+    // Find the farthest-point Voronoi diagram in a new thread (or lazily, on get(), if deferred)
+    std::future<void> ComputeDiagram(std::launch policy = std::launch::async);
 
    private:
     // Special case: all sites collinear
@@ -23,7 +22,7 @@ class FarthestPointVoronoi {
     // Incremental algorithm for farthest-point Voronoi diagram construction
     void Incremental();
 
-    // Prune deleted vertices/edges
+    // Tombstone the vertices/edges deleted by the last AddPoint
     void Prune();
 
     // Add a new point
@@ -33,15 +32,14 @@ class FarthestPointVoronoi {
     void OrientBis(geometry::Line* bis, geometry::Point a, geometry::Point b);
 
     // A helper function to help deal with half-edges
-    std::pair<Dcel::HalfEdge*, Dcel::HalfEdge*> AddHalfEdges(Dcel::Vertex* vertex, const geometry::Line& bis, int fst,
-                                                             int snd);
+    std::pair<int, int> AddHalfEdges(int vertex, const geometry::Line& bis, int fst, int snd);
 
     // Finds the initial solution for three points
     void ComputeInitialSolution(geometry::Point a, geometry::Point b, geometry::Point c);
 
-    Dcel::Face* open_face;
-    std::set<Dcel::Vertex*> vertices_pruned;
-    std::set<Dcel::HalfEdge*> edges_pruned;
+    int open_face;
+    std::vector<int> vertices_pruned;
+    std::vector<int> edges_pruned;
 
     // Clockwise and counter-clockwise neighbours
     std::vector<int> cw, ccw;
@@ -49,15 +47,16 @@ class FarthestPointVoronoi {
     // Find index in hull
     std::vector<int> inv;
 
-    // First edge for every face
+    // First edge for every face, indexed by hull index
     // Note: the face is *right* from the edge
-    std::map<int, Dcel::HalfEdge*> first_edge;
+    std::vector<int> first_edge;
 
     std::vector<geometry::Point> sites;
     std::vector<geometry::Point> hull;
 
+    // Per-instance generator so concurrent computations don't share state
+    std::mt19937 rng;
+
     Model* model;
     Dcel* dcel;
-
-    const int delay_ms = 400;  // Slow the algorithm down for better visualization of steps
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 
 #include "geometry.h"
+#include "predicates.h"
 
 #include <algorithm>
 #include <cassert>
@@ -85,7 +86,7 @@ double geometry::Dist(Point a, Point b) {
 
 int geometry::Turn(Point a, Point b, Point c) {
     // 1=left, -1=right, 0=collinear
-    double cross = (b.x - a.x) * (c.y - b.y) - (c.x - b.x) * (b.y - a.y);
+    double cross = Orient2d(a, b, c);
     if (cross > 0) {
         return 1;
     } else if (cross < 0) {
@@ -95,6 +96,14 @@ int geometry::Turn(Point a, Point b, Point c) {
     }
 }
 
+double geometry::PseudoAngle(double dx, double dy) {
+    // Goes around the unit diamond instead of the unit circle
+    double sum = std::fabs(dx) + std::fabs(dy);
+    if (sum == 0) return 0;
+    if (dy >= 0) return (dx >= 0) ? dy / sum : 1 - dx / sum;
+    return (dx < 0) ? 2 - dy / sum : 3 + dx / sum;
+}
+
 int geometry::SameSide(Point a, Point b, Point c, Point d) {
     // 1=same, -1=diff, 0=a/b on cd
     return Turn(c, d, a) * Turn(c, d, b);
@@ -137,7 +146,8 @@ double geometry::PolyArea(const std::vector<Point>& poly) {
 geometry::Point geometry::FindCircumcenter(Point a, Point b, Point c) {
     Point center;
 
-    double D = (a.x - c.x) * (b.y - c.y) - (b.x - c.x) * (a.y - c.y);
+    // The sign of the denominator is exact, so the center is never reflected
+    double D = Orient2d(a, b, c);
 
     center.x = (((a.x - c.x) * (a.x + c.x) + (a.y - c.y) * (a.y + c.y)) / 2 * (b.y - c.y) -
                 ((b.x - c.x) * (b.x + c.x) + (b.y - c.y) * (b.y + c.y)) / 2 * (a.y - c.y)) /
@@ -275,7 +285,7 @@ std::vector<geometry::Point> geometry::GrahamScanConvexHull(const std::vector<Po
             <= - the least number of points on the hull (no 3 collinear)
         */
 
-        while (Turn(hull[hull.size() - 2], hull[hull.size() - 1], all_pts[i].p) <= 0) {
+        while (hull.size() >= 2 && Turn(hull[hull.size() - 2], hull[hull.size() - 1], all_pts[i].p) <= 0) {
             hull.pop_back();
         }
         hull.push_back(all_pts[i].p);
@@ -306,6 +316,11 @@ bool geometry::CheckOrder(Point a, Point b, Point c) {
     return x && y;
 }
 
+bool geometry::AllCollinear(const std::vector<Point>& points, const PointSetInfo& info) {
+    if (info.has_box && (info.box.x1 == info.box.x2 || info.box.y1 == info.box.y2)) return true;
+    return AllCollinear(points);
+}
+
 bool geometry::AllCollinear(const std::vector<Point>& points) {
     int sz = points.size();
     if (sz == 2) return true;  // Two points are always collinear
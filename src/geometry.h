@@ -27,11 +27,23 @@ struct Rect {
     double x1, x2, y1, y2;
 };
 
+// What is known about a set of points before looking at them, e.g. from a file header, so that the stages
+// can skip their own scans. Nothing is known by default
+struct PointSetInfo {
+    bool has_box = false;
+    Rect box = {0, 0, 0, 0};      // Bounding box, if 'has_box'
+    bool sweep_sorted = false;    // In the order of Fortune's sweep: by decreasing y, ties by decreasing x
+    bool duplicate_free = false;  // No two points are equal
+};
+
 struct Annulus {
     Point center;
     double r_inner;
     double r_outer;
-    Annulus() { r_inner = r_outer = -1; }
+    Annulus() {
+        center = {0, 0, 0};
+        r_inner = r_outer = -1;
+    }
 };
 
 // Perpendicular bisector for two points
@@ -49,10 +61,13 @@ Point LineIntersection(const Line& a, const Line& b);
 // Calculates Euclidean distance
 double Dist(Point a, Point b);
 
-// Returns the turn given by a->b->c using a cross product
+// Returns the turn given by a->b->c using a cross product, the sign is exact (see predicates.h)
 // 1=left, -1=right, 0=collinear
 int Turn(Point a, Point b, Point c);
 
+// A monotone stand-in for the angle of the vector (dx, dy), in [0, 4), cheaper than atan2
+double PseudoAngle(double dx, double dy);
+
 // Checks if a and b are on the same side of (c, d)
 // 1=same, -1=diff, 0=a/b on cd
 int SameSide(Point a, Point b, Point c, Point d);
@@ -86,4 +101,7 @@ bool CheckOrder(Point a, Point b, Point c);
 
 // Checks if all points in the set are collinear
 bool AllCollinear(const std::vector<Point>& points);
+
+// Same, but points with a flat bounding box are collinear without a scan
+bool AllCollinear(const std::vector<Point>& points, const PointSetInfo& info);
 }  // namespace geometry
\ No newline at end of file
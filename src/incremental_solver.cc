@@ -0,0 +1,65 @@
+#include "incremental_solver.h"
+
+IncrementalSolver::IncrementalSolver(const MinAnnulusSolver& solver) : solver(solver) {}
+
+geometry::Annulus IncrementalSolver::Solve(const std::vector<geometry::Point>& points) {
+    SetPoints(points);
+    has_critical = false;
+    exchange_gave_up = false;
+    return SolveAll();
+}
+
+geometry::Annulus IncrementalSolver::Remeasure(const std::vector<geometry::Point>& points) {
+    SetPoints(points);
+    return SolveAll();
+}
+
+geometry::Annulus IncrementalSolver::AddPointsOrResolve(const geometry::Point* points, int k) {
+    bool inside = true;
+    for (int i = 0; i < k; i++) {
+        geometry::Point pt = points[i];
+        pt.idx = this->points.size();
+        this->points.push_back(pt);
+
+        // With fewer than two points the annulus is invalid and nothing is inside
+        double d = geometry::Dist(annulus.center, pt);
+        if (d < annulus.r_inner || d > annulus.r_outer) inside = false;
+    }
+    if (inside) return annulus;
+    return SolveAll();
+}
+
+geometry::Annulus IncrementalSolver::AddPointsOrResolve(const std::vector<geometry::Point>& points) {
+    return AddPointsOrResolve(points.data(), points.size());
+}
+
+void IncrementalSolver::SetPoints(const std::vector<geometry::Point>& points) {
+    this->points = points;
+    for (int i = 0; i < static_cast<int>(points.size()); i++) {
+        this->points[i].idx = i;
+    }
+}
+
+geometry::Annulus IncrementalSolver::SolveAll() {
+    solve_count++;
+    if (solver.GetEngine() == MinAnnulusSolver::kExchange && !exchange_gave_up) {
+        ExchangeSolver exchange(points);
+        if (has_critical && exchange.Solve(&annulus, critical)) {
+            warm_start_count++;
+            critical = exchange.GetCritical();
+            return annulus;
+        }
+        if (exchange.Solve(&annulus)) {
+            critical = exchange.GetCritical();
+            has_critical = true;
+            return annulus;
+        }
+        exchange_gave_up = true;
+    }
+
+    // The exchange, if any, gave up now or before, so go straight to the diagrams
+    has_critical = false;
+    std::vector<geometry::Annulus> top = solver.SolveTop(points, 1);
+    annulus = top.empty() ? geometry::Annulus() : top[0];
+    return annulus;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include "exchange_solver.h"
+#include "geometry.h"
+#include "min_annulus_solver.h"
+
+// Keeps the points and their smallest-width annulus, and updates it as points are added (e.g. probe points
+// added to a scan)
+// Adding points can't make the optimum narrower, so if every new point falls inside the current annulus it
+// is still the optimum: it stays valid and no annulus is narrower. That costs O(1) per new point. Only
+// a point outside of it changes the answer, then everything is solved again: the diagrams are not updated
+// in place, so that solve costs as much as the first one
+// With the exchange engine every solve starts from the critical points of the last one. They are checked
+// against the points first and only exchanged where they stopped holding the optimum, so the cost of a
+// solve follows how much the points changed
+// Inputs solved with the diagrams get no warm start, the diagrams are built again from scratch every time.
+// That includes the exchange engine once the exchange gave up on the points: later solves go straight to the
+// diagrams until Solve replaces the points
+class IncrementalSolver {
+   public:
+    IncrementalSolver(const MinAnnulusSolver& solver = MinAnnulusSolver());
+
+    // Replaces all points and solves from scratch
+    geometry::Annulus Solve(const std::vector<geometry::Point>& points);
+
+    // Replaces all points with the same points measured again, in the same order, and solves starting from
+    // the last critical points of the exchange engine (e.g. a part monitored over time), see above
+    geometry::Annulus Remeasure(const std::vector<geometry::Point>& points);
+
+    // Adds 'k' points and returns the smallest-width annulus of all points so far, solving all of them again
+    // unless every new point is inside the current annulus
+    geometry::Annulus AddPointsOrResolve(const geometry::Point* points, int k);
+    geometry::Annulus AddPointsOrResolve(const std::vector<geometry::Point>& points);
+
+    // All points so far, each with its position as index
+    const std::vector<geometry::Point>& GetPoints() const { return points; }
+
+    // Same as the last result, r_inner = r_outer = -1 if there are fewer than two points
+    const geometry::Annulus& GetAnnulus() const { return annulus; }
+
+    // Times the whole input had to be solved, including the first time
+    int GetSolveCount() const { return solve_count; }
+
+    // Solves that started from the last critical points and didn't need the diagrams
+    int GetWarmStartCount() const { return warm_start_count; }
+
+   private:
+    // Replaces the points and renumbers them
+    void SetPoints(const std::vector<geometry::Point>& points);
+
+    geometry::Annulus SolveAll();
+
+    MinAnnulusSolver solver;
+    std::vector<geometry::Point> points;
+    geometry::Annulus annulus;
+    int solve_count = 0;
+    int warm_start_count = 0;
+
+    // Critical points of the last solve, if the exchange found it
+    ExchangeSolver::Critical critical;
+    bool has_critical = false;
+
+    // The exchange gave up on the points since the last Solve, so it isn't tried again
+    bool exchange_gave_up = false;
+};
@@ -1,40 +1,63 @@
 #include <SFML/Graphics.hpp>
-#include <fstream>
 #include <iostream>
 #include "annulus_finder.h"
 #include "fp_voronoi.h"
 #include "model.h"
+#include "point_io.h"
+#include "thread_pool.h"
 #include "voronoi.h"
 #include "window.h"
 
 using namespace std;
 
-// To run: ./main <testcase_path>
+// To run: ./main [--step] <testcase_path> [trace_dir]
+// If trace_dir is given, the beach line is traced there after each step of Fortune's algorithm
+// With --step, both diagrams wait for Space after each step instead of running on a timer
 int main(int argc, char* argv[]) {
     srand(time(NULL));
-    printf("Move:ASDF | Zoom:Scroll | Change Mode:Num1-Num5 | Save Photo:P\n");
+    printf("Move:ASDF | Zoom:Scroll | Change Mode:Num1-Num5 | Save Photo:P | Next Step:Space\n");
     printf("Modes: (1) Nothing (2) Voronoi (3) FP Voronoi (4) Candidates (5) Annulus\n");
 
     // Grab command-line arguments
-    if (argc != 2) {
-        std::cout << "Error: there should be exactly 1 command-line argument." << endl;
+    bool step = false;
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--step") {
+            step = true;
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.size() != 1 && args.size() != 2) {
+        std::cout << "Error: there should be 1 or 2 command-line arguments besides --step." << endl;
         return 0;
     }
 
     // Load the testcase
     vector<geometry::Point> points;
-    ifstream in_file(argv[1]);
-    int n;
-    in_file >> n;
-    for (int i = 0; i < n; i++) {
-        double x, y;
-        in_file >> x >> y;
-        points.push_back({x, y, i});
+    if (!point_io::LoadText(args[0], &points, 0)) {
+        std::cout << "Error: cannot read " << args[0] << endl;
+        return 1;
     }
 
     // Start
     printf("Starting!\n");
     Model model(points);
+    model.SetSeed(time(NULL));
+    model.SetNumThreads(ThreadPool::DefaultNumThreads());
+    model.SetKeepCandidates(true);  // Drawn in the candidates mode
+    if (args.size() == 2) {
+        model.SetTraceDir(args[1]);
+    }
+
+    // Slow the algorithms down so that the steps can be followed
+    if (step) {
+        model.SetVoronoiPacer(new StepPacer());
+        model.SetFpVoronoiPacer(new StepPacer());
+    } else {
+        model.SetVoronoiPacer(new DelayPacer(50));
+        model.SetFpVoronoiPacer(new DelayPacer(400));
+    }
 
     // Compute a voronoi diagram in a new thread
     Voronoi voronoi(&model);
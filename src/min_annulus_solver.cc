@@ -0,0 +1,133 @@
+#include "min_annulus_solver.h"
+#include "annulus_finder.h"
+#include "core_set.h"
+#include "exchange_solver.h"
+#include "fp_voronoi.h"
+#include "model.h"
+#include "thread_pool.h"
+#include "voronoi.h"
+#include "width_evaluator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Sectors of the core set, more for a smaller 'eps', and the number of times it can grow
+const int kMinSectors = 16;
+const int kMaxSectors = 1 << 14;
+const int kMaxRounds = 16;
+
+double Width(const geometry::Annulus& ann) { return ann.r_outer - ann.r_inner; }
+
+}  // namespace
+
+MinAnnulusSolver::MinAnnulusSolver(unsigned seed, int num_threads, Engine engine)
+    : seed(seed), num_threads(num_threads), engine(engine) {}
+
+geometry::Annulus MinAnnulusSolver::Solve(const geometry::Point* points, int n,
+                                          const geometry::PointSetInfo& info) const {
+    if (engine == kExchange) {
+        std::vector<geometry::Point> sites(points, points + n);
+        ExchangeSolver exchange(sites);
+        geometry::Annulus ann;
+        if (exchange.Solve(&ann)) return ann;
+    }
+    std::vector<geometry::Annulus> top = SolveTop(points, n, 1, info);
+    return top.empty() ? geometry::Annulus() : top[0];
+}
+
+geometry::Annulus MinAnnulusSolver::Solve(const std::vector<geometry::Point>& points) const {
+    return Solve(points.data(), points.size());
+}
+
+std::vector<geometry::Annulus> MinAnnulusSolver::SolveTop(const geometry::Point* points, int n, int k,
+                                                          const geometry::PointSetInfo& info) const {
+    if (n < 2) {
+        return {};
+    }
+
+    // Sites are identified by their position in the input
+    std::vector<geometry::Point> sites(points, points + n);
+    for (int i = 0; i < n; i++) {
+        sites[i].idx = i;
+    }
+    Model model(sites);
+    model.SetVisualize(false);
+    model.SetSeed(seed);
+    model.SetNumThreads(num_threads > 0 ? num_threads : ThreadPool::DefaultNumThreads());
+    model.SetTopK(k);
+    model.SetPointSetInfo(info);
+
+    // Deferred futures: everything runs in this thread once the finder asks for the diagrams
+    Voronoi voronoi(&model);
+    std::future<void> v_fut = voronoi.ComputeDiagram(std::launch::deferred);
+    FarthestPointVoronoi fp_voronoi(&model);
+    std::future<void> fpv_fut = fp_voronoi.ComputeDiagram(std::launch::deferred);
+    AnnulusFinder annulus_finder(&v_fut, &fpv_fut, &model);
+    annulus_finder.FindAnnulus(std::launch::deferred).get();
+    return model.GetTopAnnuli();
+}
+
+std::vector<geometry::Annulus> MinAnnulusSolver::SolveTop(const std::vector<geometry::Point>& points, int k) const {
+    return SolveTop(points.data(), points.size(), k);
+}
+
+MinAnnulusSolver::ApproxAnnulus MinAnnulusSolver::SolveApprox(const geometry::Point* points, int n,
+                                                              double eps) const {
+    ApproxAnnulus result = {geometry::Annulus(), -1, -1, 0, false};
+    if (n < 2) {
+        return result;
+    }
+
+    // Small inputs are solved exactly
+    double sectors = std::ceil(M_PI / std::sqrt(std::max(eps, 0.0)));
+    int num_sectors = static_cast<int>(std::max<double>(kMinSectors, std::min<double>(kMaxSectors, sectors)));
+    if (n <= 4 * num_sectors) {
+        result.annulus = Solve(points, n);
+        result.lower = result.upper = Width(result.annulus);
+        result.core_size = n;
+        result.converged = true;
+        return result;
+    }
+
+    // Start from the sectors around the centroid
+    std::vector<geometry::Point> sites(points, points + n);
+    WidthEvaluator evaluator(sites);
+    CoreSet core(sites.data(), n);
+    geometry::Point center = {0, 0, 0};
+    for (const geometry::Point& pt : sites) {
+        center.x += pt.x / n;
+        center.y += pt.y / n;
+    }
+    for (int round = 0; round < kMaxRounds; round++) {
+        // If the core set already holds all extremes around the center, look closer
+        while (core.AddExtremes(center, num_sectors) == 0 && round > 0) {
+            if (num_sectors == kMaxSectors) return result;
+            num_sectors = std::min(kMaxSectors, 2 * num_sectors);
+        }
+
+        // The core set is a subset, so its optimum can't be wider than the real one
+        geometry::Annulus core_ann = Solve(core.GetPoints());
+        result.lower = std::max(result.lower, Width(core_ann));
+        result.core_size = core.GetPoints().size();
+
+        // Its center is a valid center for all points, just not necessarily the best one
+        geometry::Annulus full = evaluator.Enclose(core_ann.center);
+        if (result.upper < 0 || Width(full) < result.upper) {
+            result.annulus = full;
+            result.upper = Width(full);
+        }
+        if (result.upper - result.lower <= eps * result.upper) {
+            result.converged = true;
+            break;
+        }
+        center = core_ann.center;
+    }
+    return result;
+}
+
+MinAnnulusSolver::ApproxAnnulus MinAnnulusSolver::SolveApprox(const std::vector<geometry::Point>& points,
+                                                              double eps) const {
+    return SolveApprox(points.data(), points.size(), eps);
+}
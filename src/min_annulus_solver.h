@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+#include "geometry.h"
+
+// Embeddable entry point that runs the whole pipeline in the calling thread. Candidate generation can be
+// spread over 'num_threads' threads (0 for one per core), every solve then starts its own. By default it
+// stays in the calling thread too, so many concurrent solves don't start threads on top of each other
+// Every Solve call owns all of its state, so any number of solves can run concurrently
+class MinAnnulusSolver {
+   public:
+    // How Solve() finds the annulus: by overlaying the two Voronoi diagrams, or by the exchange of critical
+    // points (see exchange_solver.h), which is much faster on nearly circular inputs and falls back to the
+    // diagrams if it gives up
+    enum Engine { kDiagrams, kExchange };
+
+    MinAnnulusSolver(unsigned seed = 0, int num_threads = 1, Engine engine = kDiagrams);
+
+    Engine GetEngine() const { return engine; }
+
+    // Finds the smallest-width annulus enclosing the given points
+    // Returns an annulus with r_inner = r_outer = -1 if there are fewer than two points
+    // What is known about the points up front (see point_io.h) lets the diagrams skip some scans
+    geometry::Annulus Solve(const geometry::Point* points, int n,
+                            const geometry::PointSetInfo& info = geometry::PointSetInfo()) const;
+    geometry::Annulus Solve(const std::vector<geometry::Point>& points) const;
+
+    // Finds the 'k' best annulus candidates, best first, e.g. to look at secondary local minima
+    // Only these candidates are kept while solving, always with the diagrams. Empty if there are fewer than
+    // two points
+    std::vector<geometry::Annulus> SolveTop(const geometry::Point* points, int n, int k,
+                                            const geometry::PointSetInfo& info = geometry::PointSetInfo()) const;
+    std::vector<geometry::Annulus> SolveTop(const std::vector<geometry::Point>& points, int k) const;
+
+    // An annulus that encloses all points and bounds on the smallest width
+    struct ApproxAnnulus {
+        geometry::Annulus annulus;  // Its width is 'upper'
+        double lower, upper;        // The smallest width is in [lower, upper]
+        int core_size;              // Points the exact pipeline ran on in the last round
+        bool converged;             // If upper - lower <= eps * upper
+    };
+
+    // Finds the width to within a relative 'eps' by solving on a core set of the points (see core_set.h)
+    // instead of all of them. The optimum of the core set is a lower bound, its center measured against
+    // all points gives the upper bound; while they are too far apart, the extremes around the new center
+    // join the core set. The bounds are as exact as the pipeline itself. Inputs too small to gain from it
+    // are solved exactly
+    ApproxAnnulus SolveApprox(const geometry::Point* points, int n, double eps) const;
+    ApproxAnnulus SolveApprox(const std::vector<geometry::Point>& points, double eps) const;
+
+   private:
+    unsigned seed;  // For the randomized incremental construction
+    int num_threads;
+    Engine engine;
+};
@@ -9,7 +9,25 @@ Model::Model(const std::vector<geometry::Point>& points) {
     fp_voronoi_dcel = new Dcel();
 
     annulus = new geometry::Annulus();
-    ann_candidates = new std::vector<geometry::Annulus>();
+    candidates = new CandidateReducer();
+    visualize = true;
+    seed = 0;
+    num_threads = 1;
+    point_locator_type = PointLocator::kTrapezoidalMap;
+    walking_point_location = false;
+    voronoi_pacer = new NoPacer();
+    fp_voronoi_pacer = new NoPacer();
+}
+
+Model::~Model() {
+    delete mutex;
+    delete points;
+    delete voronoi_dcel;
+    delete fp_voronoi_dcel;
+    delete annulus;
+    delete candidates;
+    delete voronoi_pacer;
+    delete fp_voronoi_pacer;
 }
 
 void Model::InitVoronoiSweepLine() {
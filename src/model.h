@@ -2,13 +2,19 @@
 #include <algorithm>
 #include <future>
 #include <mutex>
+#include <string>
 #include <vector>
+#include "candidate_reducer.h"
 #include "dcel.h"
 #include "geometry.h"
+#include "pacer.h"
+#include "point_locator.h"
+#include "stage_times.h"
 
 class Model {
    public:
     Model(const std::vector<geometry::Point>& points);
+    ~Model();
 
     double GetSweepY() { return sweep_y; }
 
@@ -30,23 +36,93 @@ class Model {
 
     void SetHull(const std::vector<geometry::Point>& hull) { this->hull = hull; }
 
-    void AddAnnCandidate(const geometry::Annulus& ann) { ann_candidates->push_back(ann); }
+    void AddAnnCandidate(const geometry::Annulus& ann) { candidates->Add(ann); }
 
-    std::vector<geometry::Annulus> GetCandidates() { return *ann_candidates; }
+    // Adds candidates that were reduced elsewhere, e.g. by a worker thread
+    void MergeAnnCandidates(const CandidateReducer& reducer) { candidates->Merge(reducer); }
 
-    // Sort by width and select best
-    void FindBestAnnulus() {
-        std::sort(ann_candidates->begin(), ann_candidates->end(),
-                  [](const geometry::Annulus& a, const geometry::Annulus& b) {
-                      return a.r_outer - a.r_inner < b.r_outer - b.r_inner;
-                  });
-        *annulus = (*ann_candidates)[0];
-    }
+    // All candidates, only kept if asked for
+    const std::vector<geometry::Annulus>& GetCandidates() { return candidates->GetAll(); }
+
+    // The best few candidates, best first
+    std::vector<geometry::Annulus> GetTopAnnuli() { return candidates->GetTop(); }
+
+    // Measures the kept candidates against all points, see CandidateReducer::Verify()
+    void VerifyAnnCandidates(const WidthEvaluator& evaluator) { candidates->Verify(evaluator); }
+
+    // Select the best candidate
+    void FindBestAnnulus() { *annulus = candidates->GetBest(); }
 
     geometry::Annulus* GetAnnulus() { return annulus; }
 
     int GetNumSites() { return points->size(); }
 
+    // What is known about the points up front, nothing by default
+    const geometry::PointSetInfo& GetPointSetInfo() { return point_set_info; }
+
+    void SetPointSetInfo(const geometry::PointSetInfo& info) { point_set_info = info; }
+
+    // Time spent in each stage so far
+    StageTimes* GetStageTimes() { return &stage_times; }
+
+    // If unset, the algorithms skip visualization side effects (logs)
+    bool GetVisualize() { return visualize; }
+
+    void SetVisualize(bool visualize) { this->visualize = visualize; }
+
+    // Seed for the randomized parts of the algorithms
+    unsigned GetSeed() { return seed; }
+
+    void SetSeed(unsigned seed) { this->seed = seed; }
+
+    // Pacing between the steps of each algorithm, no waiting by default
+    // The model takes ownership of the pacer
+    Pacer* GetVoronoiPacer() { return voronoi_pacer; }
+
+    Pacer* GetFpVoronoiPacer() { return fp_voronoi_pacer; }
+
+    void SetVoronoiPacer(Pacer* pacer) {
+        delete voronoi_pacer;
+        voronoi_pacer = pacer;
+    }
+
+    void SetFpVoronoiPacer(Pacer* pacer) {
+        delete fp_voronoi_pacer;
+        fp_voronoi_pacer = pacer;
+    }
+
+    // How many of the best candidates to keep, and if all candidates should be kept (for drawing)
+    // Only the best one is kept by default. Changing these drops the candidates seen so far
+    int GetTopK() { return candidates->GetTopK(); }
+
+    bool GetKeepCandidates() { return candidates->GetKeepAll(); }
+
+    void SetTopK(int top_k) { *candidates = CandidateReducer(top_k, GetKeepCandidates()); }
+
+    void SetKeepCandidates(bool keep) { *candidates = CandidateReducer(GetTopK(), keep); }
+
+    // Threads for the parallel parts of the algorithms, one by default so that concurrent models don't
+    // oversubscribe the cores
+    int GetNumThreads() { return num_threads; }
+
+    void SetNumThreads(int num_threads) { this->num_threads = num_threads; }
+
+    // Point locator used to merge the diagrams
+    PointLocator::Type GetPointLocatorType() { return point_locator_type; }
+
+    void SetPointLocatorType(PointLocator::Type type) { point_locator_type = type; }
+
+    // If set, batches of queries walk the diagram from answer to answer and only ask the locator
+    // above when they can't
+    bool GetWalkingPointLocation() { return walking_point_location; }
+
+    void SetWalkingPointLocation(bool walk) { walking_point_location = walk; }
+
+    // Directory for graphviz traces of the beach line after each Fortune's step, empty if tracing is off
+    std::string GetTraceDir() { return trace_dir; }
+
+    void SetTraceDir(const std::string& trace_dir) { this->trace_dir = trace_dir; }
+
    private:
     void InitVoronoiSweepLine();
 
@@ -55,9 +131,20 @@ class Model {
     Dcel* voronoi_dcel;
     Dcel* fp_voronoi_dcel;
     std::vector<geometry::Point>* points;
+    geometry::PointSetInfo point_set_info;
+    StageTimes stage_times;
 
     geometry::Annulus* annulus;
-    std::vector<geometry::Annulus>* ann_candidates;
+    CandidateReducer* candidates;
 
     std::vector<geometry::Point> hull;  // For FP Voronoi, before shuffle
+
+    bool visualize;
+    unsigned seed;
+    int num_threads;
+    PointLocator::Type point_locator_type;
+    bool walking_point_location;
+    std::string trace_dir;
+    Pacer* voronoi_pacer;
+    Pacer* fp_voronoi_pacer;
 };
\ No newline at end of file
@@ -0,0 +1,22 @@
+#include "pacer.h"
+
+#include <chrono>
+#include <thread>
+
+DelayPacer::DelayPacer(int delay_ms) { this->delay_ms = delay_ms; }
+
+void DelayPacer::Step() { std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms)); }
+
+void StepPacer::Step() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return steps_allowed > 0; });
+    steps_allowed--;
+}
+
+void StepPacer::Advance() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        steps_allowed++;
+    }
+    cv.notify_one();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+
+// Decides how an algorithm is paced between its steps
+// Batch runs don't wait at all, the GUI slows the algorithms down or steps through them
+class Pacer {
+   public:
+    virtual ~Pacer() {}
+
+    // Called by the algorithm after each step, outside of the model lock
+    virtual void Step() = 0;
+
+    // Lets a waiting algorithm take its next step, only meaningful for step-by-step pacing
+    virtual void Advance() {}
+};
+
+// Full speed, for the CLI and the library
+class NoPacer : public Pacer {
+   public:
+    void Step() override {}
+};
+
+// Sleeps for a fixed time after each step
+class DelayPacer : public Pacer {
+   public:
+    DelayPacer(int delay_ms);
+    void Step() override;
+
+   private:
+    int delay_ms;
+};
+
+// Waits after each step until Advance() is called
+class StepPacer : public Pacer {
+   public:
+    void Step() override;
+    void Advance() override;
+
+   private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    int steps_allowed = 0;
+};
@@ -0,0 +1,396 @@
+#include "point_io.h"
+#include "thread_pool.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Chunks smaller than this aren't worth a thread
+const size_t kMinChunkSize = 1 << 20;
+
+// Powers of ten that are exact doubles
+const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Binary header, see point_io.h
+const char kMagic[8] = {'A', 'N', 'N', 'P', 'T', 'S', '0', '1'};
+const size_t kHeaderSize = 64;
+
+// Points per chunk when copying the columns
+const size_t kMinChunkPoints = 1 << 16;
+
+// A whole file mapped read-only into memory
+class MappedFile {
+   public:
+    MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            size = st.st_size;
+            valid = true;
+            if (size > 0) {
+                void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED) {
+                    valid = false;
+                } else {
+                    data = static_cast<const char*>(mapped);
+                    madvise(mapped, size, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (data != nullptr) munmap(const_cast<char*>(data), size);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool IsValid() const { return valid; }
+    const char* Begin() const { return data; }
+    const char* End() const { return data + size; }
+    size_t Size() const { return size; }
+
+   private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool valid = false;
+};
+
+// Little-endian values at any alignment
+uint64_t ReadU64(const char* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+uint32_t ReadU32(const char* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+double ReadDouble(const char* p) {
+    uint64_t bits = ReadU64(p);
+    double v;
+    memcpy(&v, &bits, 8);
+    return v;
+}
+
+void WriteU64(uint64_t v, char* p) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    memcpy(p, &v, 8);
+}
+
+void WriteU32(uint32_t v, char* p) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    memcpy(p, &v, 4);
+}
+
+void WriteDouble(double v, char* p) {
+    uint64_t bits;
+    memcpy(&bits, &v, 8);
+    WriteU64(bits, p);
+}
+
+// If 'b' comes after 'a' in the order of Fortune's sweep, or together with it
+bool SweepOrdered(const geometry::Point& a, const geometry::Point& b) {
+    return a.y > b.y || (a.y == b.y && a.x >= b.x);
+}
+
+bool IsSpace(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Number of whitespace-separated tokens that start in [begin, end), 'begin' is the start of a token or space
+long CountTokens(const char* begin, const char* end) {
+    long cnt = 0;
+    bool in_token = false;
+    for (const char* p = begin; p < end; p++) {
+        bool space = IsSpace(*p);
+        cnt += !space && !in_token;
+        in_token = !space;
+    }
+    return cnt;
+}
+
+// Parses a whole token as a double, false if it isn't one
+// Decimals with at most 19 significant digits whose mantissa and power of ten are exact doubles are
+// converted with a single correctly rounded operation, which is the exact result (Clinger's fast path);
+// everything else goes to strtod
+bool ParseDouble(const char* begin, const char* end, double* value) {
+    const char* p = begin;
+    bool negative = (p < end && (*p == '-' || *p == '+')) ? (*p++ == '-') : false;
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any_digit = false;
+    for (; p < end && IsDigit(*p); p++) {
+        any_digit = true;
+        if (mantissa == 0 && *p == '0') continue;
+        if (digits < 19) mantissa = 10 * mantissa + (*p - '0');
+        else exponent++;
+        digits++;
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && IsDigit(*p); p++) {
+            any_digit = true;
+            if (mantissa == 0 && *p == '0') {
+                exponent--;
+                continue;
+            }
+            if (digits < 19) {
+                mantissa = 10 * mantissa + (*p - '0');
+                exponent--;
+            }
+            digits++;
+        }
+    }
+    if (any_digit && p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negative_exp = (p < end && (*p == '-' || *p == '+')) ? (*p++ == '-') : false;
+        int exp = 0;
+        bool exp_digit = false;
+        for (; p < end && IsDigit(*p); p++) {
+            exp_digit = true;
+            exp = std::min(10 * exp + (*p - '0'), 100000);
+        }
+        if (!exp_digit) return false;
+        exponent += negative_exp ? -exp : exp;
+    }
+    if (!any_digit || p != end) {
+        // Not a plain decimal, e.g. "inf", strtod decides
+        std::string token(begin, end);
+        char* parsed_end;
+        *value = strtod(token.c_str(), &parsed_end);
+        return parsed_end == token.c_str() + token.size();
+    }
+    if (digits <= 19 && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        double m = static_cast<double>(mantissa);
+        *value = (exponent < 0) ? m / kPow10[-exponent] : m * kPow10[exponent];
+        if (negative) *value = -*value;
+        return true;
+    }
+    std::string token(begin, end);
+    *value = strtod(token.c_str(), nullptr);
+    return true;
+}
+
+}  // namespace
+
+namespace point_io {
+
+bool LoadText(const std::string& path, std::vector<geometry::Point>* points, int num_threads) {
+    MappedFile file(path);
+    if (!file.IsValid()) return false;
+    const char* begin = file.Begin();
+    const char* end = file.End();
+
+    // The number of points comes first
+    const char* p = begin;
+    while (p < end && IsSpace(*p)) p++;
+    const char* token = p;
+    while (p < end && !IsSpace(*p)) p++;
+    double n_value;
+    if (token == p || !ParseDouble(token, p, &n_value) || n_value < 0 || n_value > INT_MAX ||
+        n_value != static_cast<int>(n_value)) {
+        return false;
+    }
+    int n = n_value;
+
+    // Chunks start right after a space, so no token is split. Counting the tokens of every chunk first gives
+    // each chunk the index of its first coordinate
+    if (num_threads <= 0) num_threads = ThreadPool::DefaultNumThreads();
+    size_t size = end - p;
+    int num_chunks = std::max<size_t>(1, std::min<size_t>(4 * num_threads, size / kMinChunkSize));
+    std::vector<const char*> bounds = {p};
+    for (int i = 1; i < num_chunks; i++) {
+        const char* bound = std::max(bounds.back(), p + size * i / num_chunks);
+        while (bound < end && !IsSpace(*bound)) bound++;
+        bounds.push_back(bound);
+    }
+    bounds.push_back(end);
+    ThreadPool pool(std::min(num_threads, num_chunks));
+    std::vector<long> first_token(num_chunks + 1, 0);
+    pool.Run(num_chunks, [&](int i, int) { first_token[i + 1] = CountTokens(bounds[i], bounds[i + 1]); });
+    for (int i = 0; i < num_chunks; i++) {
+        first_token[i + 1] += first_token[i];
+    }
+    if (first_token[num_chunks] < 2L * n) return false;
+
+    // Every chunk writes its coordinates in place, tokens past the last coordinate are ignored
+    points->resize(n);
+    geometry::Point* out = points->data();
+    std::atomic<bool> ok(true);
+    pool.Run(num_chunks, [&](int i, int) {
+        long t = first_token[i];
+        const char* q = bounds[i];
+        while (t < 2L * n && q < bounds[i + 1]) {
+            while (q < bounds[i + 1] && IsSpace(*q)) q++;
+            if (q == bounds[i + 1]) break;
+            const char* start = q;
+            while (q < end && !IsSpace(*q)) q++;
+            double value;
+            if (!ParseDouble(start, q, &value)) {
+                ok = false;
+                return;
+            }
+            geometry::Point& pt = out[t / 2];
+            if (t % 2 == 0) {
+                pt.x = value;
+                pt.idx = t / 2;
+            } else {
+                pt.y = value;
+            }
+            t++;
+        }
+    });
+    if (!ok) points->clear();
+    return ok;
+}
+
+bool LoadBinary(const std::string& path, std::vector<geometry::Point>* points, geometry::PointSetInfo* info,
+                int num_threads) {
+    MappedFile file(path);
+    if (!file.IsValid() || file.Size() < kHeaderSize) return false;
+    const char* header = file.Begin();
+    if (memcmp(header, kMagic, sizeof(kMagic)) != 0) return false;
+    uint32_t flags = ReadU32(header + 8);
+    uint64_t n = ReadU64(header + 16);
+    if (n > INT_MAX || file.Size() != kHeaderSize + 16 * n) return false;
+    geometry::PointSetInfo header_info;
+    header_info.has_box = n > 0;
+    header_info.box = {ReadDouble(header + 24), ReadDouble(header + 32), ReadDouble(header + 40),
+                       ReadDouble(header + 48)};
+    header_info.sweep_sorted = flags & kSweepSorted;
+    header_info.duplicate_free = flags & kDuplicateFree;
+
+    // Interleaving the columns touches every point anyway, so the box and the order are checked on the way:
+    // the stages that trust them later don't check them again
+    const char* xs = header + kHeaderSize;
+    const char* ys = xs + 8 * n;
+    if (num_threads <= 0) num_threads = ThreadPool::DefaultNumThreads();
+    int num_chunks = std::max<uint64_t>(1, std::min<uint64_t>(4 * num_threads, n / kMinChunkPoints));
+    std::vector<geometry::Rect> boxes(num_chunks);
+    std::atomic<bool> ok(true);
+    points->resize(n);
+    geometry::Point* out = points->data();
+    ThreadPool pool(std::min(num_threads, num_chunks));
+    pool.Run(num_chunks, [&](int chunk, int) {
+        int lo = n * chunk / num_chunks, hi = n * (chunk + 1) / num_chunks;
+        geometry::Rect box = header_info.box;
+        bool chunk_ok = true;
+        for (int i = lo; i < hi; i++) {
+            geometry::Point& pt = out[i];
+            pt = {ReadDouble(xs + 8L * i), ReadDouble(ys + 8L * i), i};
+            if (i == lo) box = {pt.x, pt.x, pt.y, pt.y};
+            box.x1 = std::min(box.x1, pt.x);
+            box.x2 = std::max(box.x2, pt.x);
+            box.y1 = std::min(box.y1, pt.y);
+            box.y2 = std::max(box.y2, pt.y);
+        }
+
+        // The previous chunk ends with the point before 'lo', read it again to check across the border
+        if (header_info.sweep_sorted) {
+            for (int i = std::max(lo, 1); i < hi; i++) {
+                geometry::Point prev = (i == lo) ? geometry::Point({ReadDouble(xs + 8L * (i - 1)),
+                                                                    ReadDouble(ys + 8L * (i - 1)), i - 1})
+                                                 : out[i - 1];
+                bool equal = prev.x == out[i].x && prev.y == out[i].y;
+                if (!SweepOrdered(prev, out[i]) || (header_info.duplicate_free && equal)) chunk_ok = false;
+            }
+        }
+        boxes[chunk] = box;
+        if (!chunk_ok) ok = false;
+    });
+    for (int chunk = 0; chunk < num_chunks && n > 0; chunk++) {
+        const geometry::Rect& box = boxes[chunk];
+        const geometry::Rect& claimed = header_info.box;
+        if (box.x1 < claimed.x1 || box.x2 > claimed.x2 || box.y1 < claimed.y1 || box.y2 > claimed.y2) ok = false;
+    }
+    if (!ok) {
+        points->clear();
+        return false;
+    }
+    *info = header_info;
+    return true;
+}
+
+bool WriteBinary(const std::string& path, const std::vector<geometry::Point>& points) {
+    uint64_t n = points.size();
+    geometry::Rect box = {0, 0, 0, 0};
+    bool sorted = true;
+    if (n > 0) box = {points[0].x, points[0].x, points[0].y, points[0].y};
+    for (uint64_t i = 0; i < n; i++) {
+        box.x1 = std::min(box.x1, points[i].x);
+        box.x2 = std::max(box.x2, points[i].x);
+        box.y1 = std::min(box.y1, points[i].y);
+        box.y2 = std::max(box.y2, points[i].y);
+        if (i > 0 && !SweepOrdered(points[i - 1], points[i])) sorted = false;
+    }
+
+    // Equal points end up next to each other in the order of the sweep
+    std::vector<geometry::Point> by_sweep = points;
+    if (!sorted) {
+        std::sort(by_sweep.begin(), by_sweep.end(), [](const geometry::Point& a, const geometry::Point& b) {
+            return a.y > b.y || (a.y == b.y && a.x > b.x);
+        });
+    }
+    bool duplicate_free = true;
+    for (uint64_t i = 1; i < n; i++) {
+        if (by_sweep[i - 1].x == by_sweep[i].x && by_sweep[i - 1].y == by_sweep[i].y) duplicate_free = false;
+    }
+
+    std::vector<char> data(kHeaderSize + 16 * n, 0);
+    memcpy(data.data(), kMagic, sizeof(kMagic));
+    WriteU32((sorted ? kSweepSorted : 0) | (duplicate_free ? kDuplicateFree : 0), data.data() + 8);
+    WriteU64(n, data.data() + 16);
+    WriteDouble(box.x1, data.data() + 24);
+    WriteDouble(box.x2, data.data() + 32);
+    WriteDouble(box.y1, data.data() + 40);
+    WriteDouble(box.y2, data.data() + 48);
+    for (uint64_t i = 0; i < n; i++) {
+        WriteDouble(points[i].x, data.data() + kHeaderSize + 8 * i);
+        WriteDouble(points[i].y, data.data() + kHeaderSize + 8 * (n + i));
+    }
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && written;
+}
+
+bool Load(const std::string& path, std::vector<geometry::Point>* points, geometry::PointSetInfo* info,
+          int num_threads) {
+    char magic[sizeof(kMagic)] = {};
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+    bool binary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, kMagic, sizeof(magic)) == 0;
+    fclose(file);
+    if (binary) return LoadBinary(path, points, info, num_threads);
+    *info = geometry::PointSetInfo();
+    return LoadText(path, points, num_threads);
+}
+
+}  // namespace point_io
@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "geometry.h"
+
+namespace point_io {
+
+// Loads a testcase: the number of points followed by their x and y coordinates, separated by any whitespace.
+// Anything after the last coordinate is ignored, e.g. a trailing "# comment" line
+// The file is mapped into memory and big files are parsed in chunks on 'num_threads' threads (0 for one per
+// core, the caller's thread only by default), straight into 'points'. Numbers are read independently of the
+// locale, rounded as by strtod
+// Returns false if the file can't be read or holds fewer numbers than it says
+bool LoadText(const std::string& path, std::vector<geometry::Point>* points, int num_threads = 1);
+
+// Binary format: a 64-byte header followed by the x coordinates of all points, then the y coordinates, as
+// little-endian doubles. The header holds, all little-endian:
+//   char[8]  magic, "ANNPTS01"
+//   uint32   flags, kSweepSorted and kDuplicateFree
+//   uint32   zero
+//   uint64   number of points
+//   double   bounding box x1, x2, y1, y2 (min x, max x, min y, max y)
+//   char[8]  zero
+enum BinaryFlags { kSweepSorted = 1, kDuplicateFree = 2 };
+
+// Loads the binary format and fills 'info' from the header. The columns are copied straight into 'points'
+// on 'num_threads' threads, and the box and the order claimed by the header are checked along the way
+// Returns false if the file can't be read, is cut short or its header doesn't match the points
+bool LoadBinary(const std::string& path, std::vector<geometry::Point>* points, geometry::PointSetInfo* info,
+                int num_threads = 1);
+
+// Writes the binary format, the header is found from the points
+bool WriteBinary(const std::string& path, const std::vector<geometry::Point>& points);
+
+// Loads either format, telling them apart by the magic. Nothing is known about the points of a text file
+bool Load(const std::string& path, std::vector<geometry::Point>* points, geometry::PointSetInfo* info,
+          int num_threads = 1);
+
+}  // namespace point_io
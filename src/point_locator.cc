@@ -1,104 +1,178 @@
 #include "point_locator.h"
+#include "trapezoidal_map.h"
 
 #include <algorithm>
+#include <cmath>
 
-void PointLocator::LoadDcel(Dcel* dcel) {
+PointLocator* PointLocator::Create(Type type, int num_threads) {
+    if (type == kTrapezoidalMap) return new TrapezoidalMapLocator();
+    return new SlabLocator(num_threads);
+}
+
+void PointLocator::LocateBatch(const geometry::Point* pts, int n, int* out, ThreadPool* pool) {
+    std::vector<int> order(n);
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    SortQueries(pts, &order);
+
+    // Long runs keep the benefit of sorting, a few per thread even out uneven runs
+    const int kMinRun = 1024;
+    int num_threads = pool ? pool->GetNumThreads() : 1;
+    int run_sz = std::max(kMinRun, n / (4 * num_threads) + 1);
+    int num_runs = (n + run_sz - 1) / run_sz;
+    auto run = [&](int idx, int) {
+        int begin = idx * run_sz;
+        LocateRun(pts, order.data() + begin, std::min(n, begin + run_sz) - begin, out);
+    };
+    if (pool) {
+        pool->Run(num_runs, run);
+    } else {
+        for (int idx = 0; idx < num_runs; idx++) {
+            run(idx, 0);
+        }
+    }
+}
+
+void PointLocator::SortQueries(const geometry::Point* pts, std::vector<int>* order) {
+    std::sort(order->begin(), order->end(), [pts](int a, int b) {
+        return pts[a].x < pts[b].x || (pts[a].x == pts[b].x && pts[a].y < pts[b].y);
+    });
+}
+
+void PointLocator::LocateRun(const geometry::Point* pts, const int* order, int cnt, int* out) {
+    for (int i = 0; i < cnt; i++) {
+        out[order[i]] = Locate(pts[order[i]]);
+    }
+}
+
+SlabLocator::SlabLocator(int num_threads) : num_threads(num_threads) {}
+
+void SlabLocator::LoadDcel(Dcel* dcel) {
     // Init all possible slabs and add one extra slab at the end
-    double max_x = dcel->vertices[0]->point.x;
-    for (Dcel::Vertex* v : dcel->vertices) {
-        if (v->box) continue;
-        slabs[v->point.x] = {};
-        max_x = std::max(max_x, v->point.x);
+    double max_x = dcel->vertices[0].point.x;
+    slab_x.clear();
+    for (const Dcel::Vertex& v : dcel->vertices) {
+        if (v.box) continue;
+        slab_x.push_back(v.point.x);
+        max_x = std::max(max_x, v.point.x);
     }
     int offset = 100;
     double last_slab_x = max_x + offset;
-    slabs[last_slab_x] = {};
+    slab_x.push_back(last_slab_x);
+    std::sort(slab_x.begin(), slab_x.end());
+    slab_x.erase(std::unique(slab_x.begin(), slab_x.end()), slab_x.end());
+    int num_slabs = slab_x.size();
+    auto first_slab = [this](double x) { return std::lower_bound(slab_x.begin(), slab_x.end(), x) - slab_x.begin(); };
 
-    // Binary search for each edge
+    // Binary search for each edge, every edge covers a range of consecutive slabs
+    struct Range {
+        int begin, end;
+        Info info;
+    };
+    std::vector<Range> ranges;
     verticals = true;
-    for (Dcel::HalfEdge* he : dcel->half_edges) {
+    int he_sz = dcel->half_edges.size();
+    for (int idx = 0; idx < he_sz; idx++) {
         // Avoid doubles and box edges
-        if (he->incident_face < he->twin->incident_face) continue;
-        if (he->origin->box && he->twin->origin->box) continue;
+        int he = idx;
+        if (dcel->Site(he) < dcel->Site(dcel->Twin(he))) continue;
+        if (dcel->OriginOnBox(he) && dcel->OriginOnBox(dcel->Twin(he))) continue;
 
-        if (!he->origin->box && !he->twin->origin->box) {
+        if (!dcel->OriginOnBox(he) && !dcel->OriginOnBox(dcel->Twin(he))) {
             // One point is on the box: half-infinite edge
-            if (he->origin->point.x > he->twin->origin->point.x) he = he->twin;
+            if (dcel->OriginPoint(he).x > dcel->OriginPoint(dcel->Twin(he)).x) he = dcel->Twin(he);
+            int twin = dcel->Twin(he);
+            const geometry::Line& line = dcel->half_edges[he].line;
 
             // Find first y bigger or equal = first slab I intersect
-            auto it = slabs.lower_bound(he->origin->point.x);
-            ++it;
-            double last = it->first;
-            double R = he->twin->origin->point.x;
+            int begin = std::min<int>(first_slab(dcel->OriginPoint(he).x) + 1, num_slabs);
+            double R = dcel->OriginPoint(twin).x;
 
             // Add to all slabs
-            while (it != slabs.end() && (last < R || std::fabs(last - R) < 1e-6)) {
-                it->second.push_back({he->line, he->incident_face->site, he->twin->incident_face->site});
+            int end = begin;
+            while (end < num_slabs && (slab_x[end] < R || std::fabs(slab_x[end] - R) < 1e-6)) end++;
+            if (end > begin) {
+                ranges.push_back({begin, end, {line.k, line.n, dcel->Site(he), dcel->Site(twin)}});
                 verticals = false;
-                ++it;
-                last = it->first;
             }
         } else {
             // A regular edge inside the box
-            if (he->origin->box) he = he->twin;
-            if (he->line.vertical) {
+            if (dcel->OriginOnBox(he)) he = dcel->Twin(he);
+            int twin = dcel->Twin(he);
+            const geometry::Line& line = dcel->half_edges[he].line;
+            if (line.vertical) {
                 // A single vertical line
                 // If all are vertical, there are only two farthest-point faces 
-                vert_L = (he->line.dir == 'd') ? he->incident_face->site : he->twin->incident_face->site;
-                vert_R = (he->line.dir == 'u') ? he->incident_face->site : he->twin->incident_face->site;
-                vert_thresh = he->line.x;
+                vert_L = (line.dir == 'd') ? dcel->Site(he) : dcel->Site(twin);
+                vert_R = (line.dir == 'u') ? dcel->Site(he) : dcel->Site(twin);
+                vert_thresh = line.x;
                 continue;
             }
 
-            // Find first y bigger or equal = first slab I intersect
-            auto it = slabs.lower_bound(he->origin->point.x);
-            if (he->line.dir == 'r') ++it;
-            while (it != slabs.end()) {
+            // Find first y bigger or equal = first slab I intersect, then go in a right direction
+            int slab = first_slab(dcel->OriginPoint(he).x);
+            int begin = (line.dir == 'r') ? slab + 1 : 0;
+            int end = (line.dir == 'r') ? num_slabs : std::min(slab + 1, num_slabs);
+            if (end > begin) {
                 // Find surrounding sites
-                int site_below = (he->line.dir == 'r') ? he->incident_face->site : he->twin->incident_face->site;
-                int site_above = (he->line.dir == 'l') ? he->incident_face->site : he->twin->incident_face->site;
-                it->second.push_back({he->line, site_below, site_above});
+                int site_below = (line.dir == 'r') ? dcel->Site(he) : dcel->Site(twin);
+                int site_above = (line.dir == 'l') ? dcel->Site(he) : dcel->Site(twin);
+                ranges.push_back({begin, end, {line.k, line.n, site_below, site_above}});
                 verticals = false;
-
-                // Move in a right direction
-                if (he->line.dir == 'r') {
-                    ++it;
-                } else {
-                    if (it == slabs.begin()) break;
-                    --it;
-                }
             }
         }
     }
 
+    // Freeze the slabs into one flat array, each slab keeps the lines in the order of the edges
+    slab_start.assign(num_slabs + 1, 0);
+    for (const Range& range : ranges) {
+        for (int slab = range.begin; slab < range.end; slab++) {
+            slab_start[slab + 1]++;
+        }
+    }
+    for (int slab = 0; slab < num_slabs; slab++) {
+        slab_start[slab + 1] += slab_start[slab];
+    }
+    lines.resize(slab_start[num_slabs]);
+    std::vector<int> fill(slab_start.begin(), slab_start.end() - 1);
+    for (const Range& range : ranges) {
+        for (int slab = range.begin; slab < range.end; slab++) {
+            lines[fill[slab]++] = range.info;
+        }
+    }
+
     if (verticals) {
         // All done if they were vertical, will be handed separately
         return;
     }
 
-    // Sort lines in every individual slab by y
-    double last_x;
-    bool fst = true;
-    for (std::pair<const double, std::vector<Info>>& kv : slabs) {
-        double x = kv.first;
-        if (fst) last_x = x - 10;
-        fst = false;
-        std::sort(kv.second.begin(), kv.second.end(), [last_x, x](const Info& a, const Info& b) {
-            double ay = a.line.k * x + a.line.n;
-            double by = b.line.k * x + b.line.n;
-            if (fabs(ay - by) < 1e-6) {
-                double ay2 = a.line.k * last_x + a.line.n;
-                double by2 = b.line.k * last_x + b.line.n;
-                return ay2 < by2;
-            } else {
-                return ay < by;
-            }
-        });
-        last_x = x;
-    }
+    // Sort lines in every individual slab by y, slabs are independent
+    ThreadPool pool(num_threads);
+    int chunk_sz = std::max(1, num_slabs / (8 * pool.GetNumThreads()));
+    int num_chunks = (num_slabs + chunk_sz - 1) / chunk_sz;
+    pool.Run(num_chunks, [&](int chunk, int) {
+        int chunk_end = std::min(num_slabs, (chunk + 1) * chunk_sz);
+        for (int slab = chunk * chunk_sz; slab < chunk_end; slab++) {
+            double x = slab_x[slab];
+            double last_x = (slab == 0) ? x - 10 : slab_x[slab - 1];
+            std::sort(lines.begin() + slab_start[slab], lines.begin() + slab_start[slab + 1],
+                      [last_x, x](const Info& a, const Info& b) {
+                          double ay = a.k * x + a.n;
+                          double by = b.k * x + b.n;
+                          if (fabs(ay - by) < 1e-6) {
+                              double ay2 = a.k * last_x + a.n;
+                              double by2 = b.k * last_x + b.n;
+                              return ay2 < by2;
+                          } else {
+                              return ay < by;
+                          }
+                      });
+        }
+    });
 }
 
-int PointLocator::Locate(geometry::Point pt) {
+int SlabLocator::Locate(geometry::Point pt) {
     // Locate a given point
     if (verticals) {
         // If all are vertical, there are only two farthest-point faces 
@@ -106,17 +180,36 @@ int PointLocator::Locate(geometry::Point pt) {
     }
 
     // Binary search the right slab
-    auto it = slabs.lower_bound(pt.x);
-    if (it == slabs.end()) --it;
-    auto vec = it->second;
-    int sz = vec.size();
+    int slab = std::lower_bound(slab_x.begin(), slab_x.end(), pt.x) - slab_x.begin();
+    return LocateInSlab(std::min<int>(slab, slab_x.size() - 1), pt);
+}
+
+void SlabLocator::LocateRun(const geometry::Point* pts, const int* order, int cnt, int* out) {
+    if (verticals) {
+        PointLocator::LocateRun(pts, order, cnt, out);
+        return;
+    }
+
+    // Queries come sorted by x, so the slab of the next one is never to the left
+    int num_slabs = slab_x.size();
+    int slab = std::lower_bound(slab_x.begin(), slab_x.end(), pts[order[0]].x) - slab_x.begin();
+    for (int i = 0; i < cnt; i++) {
+        geometry::Point pt = pts[order[i]];
+        while (slab < num_slabs && slab_x[slab] < pt.x) slab++;
+        out[order[i]] = LocateInSlab(std::min(slab, num_slabs - 1), pt);
+    }
+}
+
+int SlabLocator::LocateInSlab(int slab, geometry::Point pt) const {
+    const Info* infos = lines.data() + slab_start[slab];
+    int sz = slab_start[slab + 1] - slab_start[slab];
+    if (sz == 0) return 0;
 
     // Binary search in a slab, look for the last line that's above
     int lo = 0, hi = sz - 1, pivot;
     while (lo < hi) {
         pivot = (lo + hi) / 2;
-        auto line = vec[pivot].line;
-        double y = line.k * pt.x + line.n;
+        double y = infos[pivot].k * pt.x + infos[pivot].n;
         if (y >= pt.y)
             hi = pivot;
         else
@@ -124,10 +217,9 @@ int PointLocator::Locate(geometry::Point pt) {
     }
 
     // Return the site tied to the face
-    auto line = vec[lo].line;
-    double y = line.k * pt.x + line.n;
+    double y = infos[lo].k * pt.x + infos[lo].n;
     if (y > pt.y)
-        return vec[lo].site_below;
+        return infos[lo].site_below;
     else
-        return vec.back().site_above;
+        return infos[sz - 1].site_above;
 }
@@ -1,30 +1,72 @@
 #pragma once
-#include <map>
 #include <vector>
 #include "dcel.h"
 #include "geometry.h"
+#include "thread_pool.h"
 
 // Preprocesses a given DCEL for point location queries
-// Uses vertical slabs
-// TODO: trapezoidal maps
+// Locate() only reads, so queries can run concurrently once the DCEL is loaded
 class PointLocator {
    public:
+    enum Type { kSlabs, kTrapezoidalMap };
+
+    // Creates a locator of a given type, the caller takes ownership
+    // Locators that build in parallel use up to 'num_threads' threads
+    static PointLocator* Create(Type type, int num_threads = 1);
+
+    virtual ~PointLocator() {}
+
     // Preprocess a DCEL
-    void LoadDcel(Dcel* dcel);
+    virtual void LoadDcel(Dcel* dcel) = 0;
 
     // Answer a query: find a face that holds a given point
-    int Locate(geometry::Point pt);
+    virtual int Locate(geometry::Point pt) = 0;
+
+    // Answers many queries at once, out[i] is the face that holds pts[i]
+    // Queries are sorted (by x unless the locator prefers another order) and split into runs,
+    // one run per task on the pool (if any)
+    void LocateBatch(const geometry::Point* pts, int n, int* out, ThreadPool* pool = nullptr);
+
+   protected:
+    // Sorts query indices into the order runs are answered in
+    virtual void SortQueries(const geometry::Point* pts, std::vector<int>* order);
+
+    // Answers a run of queries, pts[order[0]], ..., pts[order[cnt - 1]], in sorted order
+    // Locators that can carry state from one query to the next one override this
+    virtual void LocateRun(const geometry::Point* pts, const int* order, int cnt, int* out);
+};
+
+// Uses vertical slabs: O(log n) queries, but O(n^2) space in the worst case
+// Once built, the slabs are frozen into flat arrays
+class SlabLocator : public PointLocator {
+   public:
+    // Slabs are sorted on 'num_threads' threads
+    SlabLocator(int num_threads = 1);
+
+    void LoadDcel(Dcel* dcel) override;
+    int Locate(geometry::Point pt) override;
+
+   protected:
+    // Walks the slabs from left to right instead of searching for each one
+    void LocateRun(const geometry::Point* pts, const int* order, int cnt, int* out) override;
 
    private:
     // A single line that intersects a slab
     struct Info {
-        geometry::Line line;
+        double k, n;
         int site_below;
         int site_above;
     };
 
-    // Maps right_y to a vector of lines that intersect a slab
-    std::map<double, std::vector<Info>> slabs;
+    // Binary search in a slab
+    int LocateInSlab(int slab, geometry::Point pt) const;
+
+    int num_threads;
+
+    // Slab 'i' ends at slab_x[i] and holds lines[slab_start[i]], ..., lines[slab_start[i + 1] - 1], sorted by y
+    std::vector<double> slab_x;
+    std::vector<int> slab_start;
+    std::vector<Info> lines;
 
     // If all edges are vertical it's a special case
     bool verticals = false;
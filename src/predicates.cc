@@ -0,0 +1,288 @@
+#include "predicates.h"
+
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Half an ulp of 1, the relative error of a single rounded operation
+const double kEpsilon = 0.5 * 2.220446049250313e-16;
+
+// Error bounds of the double evaluation, relative to the permanent of the determinant
+const double kOrientBound = (3 + 16 * kEpsilon) * kEpsilon;
+const double kInCircleBound = (10 + 96 * kEpsilon) * kEpsilon;
+
+// Same for the two terms of CircleBottom, of degree 3 and 6, with about twice the rounded operations each
+// term goes through
+const double kBottomCenterBound = 16 * kEpsilon;
+const double kBottomBound = 32 * kEpsilon;
+
+// Splits a double into two halves that multiply without rounding
+const double kSplitter = 134217729.0;  // 2^27 + 1
+
+// An exact value as a sum of non-overlapping doubles, from the smallest to the biggest one
+// Zeros are left out, so an empty expansion is zero
+typedef std::vector<double> Expansion;
+
+// a + b = x + y exactly, x is the rounded sum
+void TwoSum(double a, double b, double* x, double* y) {
+    *x = a + b;
+    double b_virt = *x - a;
+    double a_virt = *x - b_virt;
+    *y = (a - a_virt) + (b - b_virt);
+}
+
+// Same as TwoSum, but needs |a| >= |b|
+void FastTwoSum(double a, double b, double* x, double* y) {
+    *x = a + b;
+    *y = b - (*x - a);
+}
+
+// a * b = x + y exactly, x is the rounded product
+void TwoProduct(double a, double b, double* x, double* y) {
+    *x = a * b;
+    double c = kSplitter * a;
+    double a_hi = c - (c - a), a_lo = a - a_hi;
+    c = kSplitter * b;
+    double b_hi = c - (c - b), b_lo = b - b_hi;
+    double err = *x - a_hi * b_hi - a_lo * b_hi - a_hi * b_lo;
+    *y = a_lo * b_lo - err;
+}
+
+// a - b as an expansion
+Expansion Diff(double a, double b) {
+    double x = a - b;
+    double b_virt = a - x;
+    double y = (a - (x + b_virt)) + (b_virt - b);
+    Expansion e;
+    if (y != 0) e.push_back(y);
+    if (x != 0) e.push_back(x);
+    return e;
+}
+
+// e + b
+Expansion Grow(const Expansion& e, double b) {
+    Expansion h;
+    double q = b, hh;
+    for (double comp : e) {
+        TwoSum(q, comp, &q, &hh);
+        if (hh != 0) h.push_back(hh);
+    }
+    if (q != 0) h.push_back(q);
+    return h;
+}
+
+// e + f
+Expansion Sum(const Expansion& e, const Expansion& f) {
+    Expansion h = e;
+    for (double comp : f) {
+        h = Grow(h, comp);
+    }
+    return h;
+}
+
+// e * b
+Expansion Scale(const Expansion& e, double b) {
+    Expansion h;
+    if (e.empty() || b == 0) return h;
+    double q, hh;
+    TwoProduct(e[0], b, &q, &hh);
+    if (hh != 0) h.push_back(hh);
+    for (size_t i = 1; i < e.size(); i++) {
+        double prod_hi, prod_lo, sum;
+        TwoProduct(e[i], b, &prod_hi, &prod_lo);
+        TwoSum(q, prod_lo, &sum, &hh);
+        if (hh != 0) h.push_back(hh);
+        FastTwoSum(prod_hi, sum, &q, &hh);
+        if (hh != 0) h.push_back(hh);
+    }
+    if (q != 0) h.push_back(q);
+    return h;
+}
+
+// e * f
+Expansion Product(const Expansion& e, const Expansion& f) {
+    Expansion h;
+    for (double comp : f) {
+        h = Sum(h, Scale(e, comp));
+    }
+    return h;
+}
+
+// The biggest component has the sign of the whole expansion
+double Approximate(const Expansion& e) { return e.empty() ? 0 : e.back(); }
+
+// Counters of a single thread, only the owner writes them so the increments need no atomic operations
+// They are constant initialized, so counting costs no more than a thread-local add
+struct Counters {
+    std::atomic<long long> orient_calls, orient_exact;
+    std::atomic<long long> incircle_calls, incircle_exact;
+};
+
+thread_local Counters counters = {{0}, {0}, {0}, {0}};
+
+// A thread registers its counters on its first call, the totals of finished threads are kept aside
+struct Registry {
+    std::mutex mutex;
+    std::vector<Counters*> live;
+    geometry::PredicateCounters retired = {0, 0, 0, 0};
+};
+
+// Constructed before any thread registers, so it outlives all of them
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+// Moves the counters of a thread into the retired totals when the thread exits
+struct Registration {
+    Registration() {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.live.push_back(&counters);
+    }
+    ~Registration() {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.retired.orient_calls += counters.orient_calls;
+        registry.retired.orient_exact += counters.orient_exact;
+        registry.retired.incircle_calls += counters.incircle_calls;
+        registry.retired.incircle_exact += counters.incircle_exact;
+        for (size_t i = 0; i < registry.live.size(); i++) {
+            if (registry.live[i] == &counters) {
+                registry.live[i] = registry.live.back();
+                registry.live.pop_back();
+                break;
+            }
+        }
+    }
+};
+
+thread_local bool registered = false;
+
+void Register() {
+    thread_local Registration registration;
+    registered = true;
+}
+
+void Increment(std::atomic<long long>* counter) {
+    if (!registered) Register();
+    counter->store(counter->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+double geometry::Orient2d(Point a, Point b, Point c) {
+    Increment(&counters.orient_calls);
+    double det_left = (a.x - c.x) * (b.y - c.y);
+    double det_right = (a.y - c.y) * (b.x - c.x);
+    double det = det_left - det_right;
+
+    // Without cancellation |det| is the permanent and always passes, so there is no need to branch on the signs
+    double bound = kOrientBound * (std::fabs(det_left) + std::fabs(det_right));
+    if (std::fabs(det) >= bound) return det;
+
+    // Too close to call, do it exactly
+    Increment(&counters.orient_exact);
+    Expansion left = Product(Diff(a.x, c.x), Diff(b.y, c.y));
+    Expansion right = Product(Diff(a.y, c.y), Diff(b.x, c.x));
+    return Approximate(Sum(left, Scale(right, -1)));
+}
+
+double geometry::InCircle(Point a, Point b, Point c, Point d) {
+    Increment(&counters.incircle_calls);
+    double adx = a.x - d.x, ady = a.y - d.y;
+    double bdx = b.x - d.x, bdy = b.y - d.y;
+    double cdx = c.x - d.x, cdy = c.y - d.y;
+
+    double bdx_cdy = bdx * cdy, cdx_bdy = cdx * bdy;
+    double a_lift = adx * adx + ady * ady;
+    double cdx_ady = cdx * ady, adx_cdy = adx * cdy;
+    double b_lift = bdx * bdx + bdy * bdy;
+    double adx_bdy = adx * bdy, bdx_ady = bdx * ady;
+    double c_lift = cdx * cdx + cdy * cdy;
+    double det = a_lift * (bdx_cdy - cdx_bdy) + b_lift * (cdx_ady - adx_cdy) + c_lift * (adx_bdy - bdx_ady);
+
+    double permanent = (std::fabs(bdx_cdy) + std::fabs(cdx_bdy)) * a_lift +
+                       (std::fabs(cdx_ady) + std::fabs(adx_cdy)) * b_lift +
+                       (std::fabs(adx_bdy) + std::fabs(bdx_ady)) * c_lift;
+    double bound = kInCircleBound * permanent;
+    if (std::fabs(det) > bound) return det;
+
+    // Too close to call, do it exactly
+    Increment(&counters.incircle_exact);
+    Expansion adx_e = Diff(a.x, d.x), ady_e = Diff(a.y, d.y);
+    Expansion bdx_e = Diff(b.x, d.x), bdy_e = Diff(b.y, d.y);
+    Expansion cdx_e = Diff(c.x, d.x), cdy_e = Diff(c.y, d.y);
+    auto minor = [](const Expansion& px, const Expansion& py, const Expansion& qx, const Expansion& qy) {
+        return Sum(Product(px, qy), Scale(Product(qx, py), -1));
+    };
+    auto lift = [](const Expansion& px, const Expansion& py) { return Sum(Product(px, px), Product(py, py)); };
+    Expansion exact = Product(lift(adx_e, ady_e), minor(bdx_e, bdy_e, cdx_e, cdy_e));
+    exact = Sum(exact, Product(lift(bdx_e, bdy_e), minor(cdx_e, cdy_e, adx_e, ady_e)));
+    exact = Sum(exact, Product(lift(cdx_e, cdy_e), minor(adx_e, ady_e, bdx_e, bdy_e)));
+    return Approximate(exact);
+}
+
+double geometry::CircleBottom(Point a, Point b, Point c, double y) {
+    Increment(&counters.incircle_calls);
+    double sign = (Orient2d(a, b, c) > 0) ? 1 : -1;
+
+    // With c as the origin the center is (nx, ny) / 2d, where d is the orientation. The lowest point is above
+    // the line if the center is, by t / 2|d| with t = sign * (2dh + ny), and t^2 > nx^2 + ny^2, which is q > 0
+    double ax = a.x - c.x, ay = a.y - c.y, bx = b.x - c.x, by = b.y - c.y, h = c.y - y;
+    double d = ax * by - ay * bx;
+    double a_lift = ax * ax + ay * ay, b_lift = bx * bx + by * by;
+    double nx = a_lift * by - b_lift * ay, ny = b_lift * ax - a_lift * bx;
+    double dh = d * h;
+    double t = sign * (2 * dh + ny);
+    double q = 4 * dh * (dh + ny) - nx * nx;
+
+    double dh_permanent = (std::fabs(ax * by) + std::fabs(ay * bx)) * std::fabs(h);
+    double nx_permanent = a_lift * std::fabs(by) + b_lift * std::fabs(ay);
+    double ny_permanent = b_lift * std::fabs(ax) + a_lift * std::fabs(bx);
+    bool t_sure = std::fabs(t) > kBottomCenterBound * (2 * dh_permanent + ny_permanent);
+    if (t_sure && t < 0) return -1;
+    double q_bound = kBottomBound * (4 * dh_permanent * (dh_permanent + ny_permanent) + nx_permanent * nx_permanent);
+    if (t_sure && std::fabs(q) > q_bound) return q;
+
+    // Too close to call, do it exactly
+    Increment(&counters.incircle_exact);
+    Expansion ax_e = Diff(a.x, c.x), ay_e = Diff(a.y, c.y);
+    Expansion bx_e = Diff(b.x, c.x), by_e = Diff(b.y, c.y);
+    Expansion d_e = Sum(Product(ax_e, by_e), Scale(Product(ay_e, bx_e), -1));
+    Expansion a_lift_e = Sum(Product(ax_e, ax_e), Product(ay_e, ay_e));
+    Expansion b_lift_e = Sum(Product(bx_e, bx_e), Product(by_e, by_e));
+    Expansion nx_e = Sum(Product(a_lift_e, by_e), Scale(Product(b_lift_e, ay_e), -1));
+    Expansion ny_e = Sum(Product(b_lift_e, ax_e), Scale(Product(a_lift_e, bx_e), -1));
+    Expansion dh_e = Product(d_e, Diff(c.y, y));
+    if (sign * Approximate(Sum(Scale(dh_e, 2), ny_e)) <= 0) return -1;
+    return Approximate(Sum(Scale(Product(dh_e, Sum(dh_e, ny_e)), 4), Scale(Product(nx_e, nx_e), -1)));
+}
+
+geometry::PredicateCounters geometry::GetPredicateCounters() {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    PredicateCounters total = registry.retired;
+    for (const Counters* c : registry.live) {
+        total.orient_calls += c->orient_calls.load(std::memory_order_relaxed);
+        total.orient_exact += c->orient_exact.load(std::memory_order_relaxed);
+        total.incircle_calls += c->incircle_calls.load(std::memory_order_relaxed);
+        total.incircle_exact += c->incircle_exact.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void geometry::ResetPredicateCounters() {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.retired = {0, 0, 0, 0};
+    for (Counters* c : registry.live) {
+        c->orient_calls = 0;
+        c->orient_exact = 0;
+        c->incircle_calls = 0;
+        c->incircle_exact = 0;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "geometry.h"
+
+// Filtered geometric predicates, in the style of Shewchuk's "Adaptive Precision Floating-Point
+// Arithmetic and Fast Robust Geometric Predicates"
+// The determinant is first evaluated in doubles, when its magnitude is below a forward error bound
+// the sign can't be trusted and it is recomputed exactly with floating-point expansions
+// The returned value is only an approximation of the determinant, but its sign is always right
+namespace geometry {
+
+// Twice the signed area of abc: >0 if abc is counterclockwise, <0 if clockwise, 0 if collinear
+double Orient2d(Point a, Point b, Point c);
+
+// >0 if d is inside the circle through a, b and c (in counterclockwise order), <0 if outside, 0 if on it
+double InCircle(Point a, Point b, Point c, Point d);
+
+// >0 if the lowest point of the circle through a, b and c (not collinear) is above the horizontal line at 'y',
+// <0 if below, 0 if on it. Only the sign is meaningful. Counted with InCircle
+double CircleBottom(Point a, Point b, Point c, double y);
+
+// How often the predicates were called and how often the filter failed, summed over all threads
+struct PredicateCounters {
+    long long orient_calls, orient_exact;
+    long long incircle_calls, incircle_exact;
+};
+PredicateCounters GetPredicateCounters();
+
+// Only meant to be called while no predicates are running
+void ResetPredicateCounters();
+}  // namespace geometry
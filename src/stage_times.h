@@ -0,0 +1,34 @@
+#pragma once
+#include <chrono>
+
+// Wall time of the pipeline stages in seconds, filled in by the stages as they run
+// Every field is written by one thread only, so the two diagrams can be timed while they run concurrently
+struct StageTimes {
+    // Convex hull for the farthest-point diagram
+    double hull = 0;
+
+    // Fortune's sweep and the farthest-point incremental construction, without the hull and the boxes
+    double fortune = 0;
+    double fp_incremental = 0;
+
+    // AddBox of each diagram
+    double voronoi_box = 0;
+    double fp_voronoi_box = 0;
+
+    // Building both point locators
+    double locators = 0;
+
+    // Edge pieces, crossing pairs and locating the vertices of each diagram in the other one
+    double overlay = 0;
+
+    // Each candidate type, summed over the threads that generate it
+    double candidates[3] = {0, 0, 0};
+
+    // Merging the candidates, measuring the best ones again and picking the winner
+    double reduction = 0;
+};
+
+// Seconds since 'start'
+inline double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
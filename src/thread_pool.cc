@@ -0,0 +1,66 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int num_threads) : next_task(0) {
+    for (int i = 1; i < num_threads; i++) {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    batch_ready.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::DefaultNumThreads() { return std::max(1u, std::thread::hardware_concurrency()); }
+
+void ThreadPool::Run(int num_tasks, const std::function<void(int, int)>& task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        this->num_tasks = num_tasks;
+        next_task = 0;
+        busy_workers = workers.size();
+        batch++;
+    }
+    batch_ready.notify_all();
+    RunTasks(0);
+
+    // Every worker has to check in, even if there was nothing left for it
+    std::unique_lock<std::mutex> lock(mutex);
+    batch_done.wait(lock, [this] { return busy_workers == 0; });
+    this->task = nullptr;
+}
+
+void ThreadPool::WorkerLoop(int thread) {
+    unsigned last_batch = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            batch_ready.wait(lock, [this, last_batch] { return stop || batch != last_batch; });
+            if (stop) return;
+            last_batch = batch;
+        }
+        RunTasks(thread);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busy_workers--;
+        }
+        batch_done.notify_one();
+    }
+}
+
+void ThreadPool::RunTasks(int thread) {
+    while (true) {
+        int idx = next_task++;
+        if (idx >= num_tasks) return;
+        (*task)(idx, thread);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads that run batches of independent tasks
+// The thread calling Run() works on the batch too, so a pool of 1 thread spawns no workers
+class ThreadPool {
+   public:
+    ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    // Runs task(0, thread), ..., task(num_tasks - 1, thread) and returns once all of them are done
+    // Tasks are handed out in order, but may finish in any order. 'thread' is the index of the thread
+    // running the task, in [0, GetNumThreads()), so tasks can share per-thread scratch space
+    void Run(int num_tasks, const std::function<void(int, int)>& task);
+
+    int GetNumThreads() { return workers.size() + 1; }
+
+    // Number of threads to use by default, one per core
+    static int DefaultNumThreads();
+
+   private:
+    // Waits for batches and works on them until the pool is destroyed
+    void WorkerLoop(int thread);
+
+    // Takes tasks from the current batch until there are none left
+    void RunTasks(int thread);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable batch_ready, batch_done;
+
+    // Current batch
+    const std::function<void(int, int)>* task = nullptr;
+    int num_tasks = 0;
+    std::atomic<int> next_task;
+    int busy_workers = 0;
+    unsigned batch = 0;  // Bumped for every batch, so workers don't run one twice
+    bool stop = false;
+};
@@ -0,0 +1,54 @@
+#include "trace_writer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+TraceWriter::TraceWriter(const std::string& dir) : dir(dir) { writer = std::thread(&TraceWriter::Run, this); }
+
+TraceWriter::~TraceWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    cv.notify_one();
+    writer.join();
+}
+
+void TraceWriter::Add(const std::string& name, std::string dot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.emplace_back(name, std::move(dot));
+    }
+    cv.notify_one();
+}
+
+void TraceWriter::Run() {
+    std::vector<std::pair<std::string, std::string>> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return done || !queue.empty(); });
+            if (queue.empty()) return;  // Done and nothing left to write
+            batch.swap(queue);
+        }
+        WriteBatch(batch);
+        batch.clear();
+    }
+}
+
+void TraceWriter::WriteBatch(const std::vector<std::pair<std::string, std::string>>& batch) {
+    std::string command = "dot -Tpng -O";
+    for (const auto& trace : batch) {
+        std::string path = dir + "/" + trace.first + ".dot";
+        std::ofstream dot_file(path);
+        dot_file << trace.second;
+        command += " " + path;
+    }
+    // Keep only the .dot files if rendering fails once
+    if (!render) return;
+    if (system(command.c_str()) != 0) {
+        fprintf(stderr, "Tracing: dot failed, is graphviz installed? Only writing .dot files\n");
+        render = false;
+    }
+}
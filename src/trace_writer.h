@@ -0,0 +1,36 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Writes graphviz traces to disk in a background thread
+// Add() only queues the trace, the writer thread picks up everything queued so far,
+// writes the .dot files and renders the whole batch with a single dot call
+class TraceWriter {
+   public:
+    TraceWriter(const std::string& dir);
+
+    // Flushes everything that's still queued
+    ~TraceWriter();
+
+    // Queues dir/name.dot, rendered to dir/name.dot.png
+    void Add(const std::string& name, std::string dot);
+
+   private:
+    // Writer thread loop
+    void Run();
+
+    // Writes and renders one batch
+    void WriteBatch(const std::vector<std::pair<std::string, std::string>>& batch);
+
+    std::string dir;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::pair<std::string, std::string>> queue;  // (name, dot) pairs
+    bool done = false;
+    bool render = true;  // Only touched by the writer thread
+    std::thread writer;
+};
@@ -0,0 +1,190 @@
+#include "trapezoidal_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace {
+
+const double kInf = std::numeric_limits<double>::infinity();
+
+// The (x, y) order of points, i.e. the x order after a symbolic shear
+bool LexLess(geometry::Point a, geometry::Point b) { return a.x < b.x || (a.x == b.x && a.y < b.y); }
+
+// Where a ray from 'origin' in a given direction ends up
+geometry::Point PointAtInfinity(geometry::Point origin, double dx, double dy) {
+    if (dx > 0) return {kInf, 0, 0};
+    if (dx < 0) return {-kInf, 0, 0};
+    return {origin.x, (dy > 0) ? kInf : -kInf, 0};
+}
+
+}  // namespace
+
+void TrapezoidalMapLocator::LoadDcel(Dcel* dcel) {
+    segments.clear();
+    trapezoids.clear();
+    nodes.clear();
+
+    // Every edge once, box edges are dropped and edges that reach the box become rays
+    int open_site = dcel->faces.back().site;
+    int he_sz = dcel->half_edges.size();
+    for (int idx = 0; idx < he_sz; idx++) {
+        int he = idx;
+        int twin = dcel->Twin(he);
+        if (dcel->Live(he) == Dcel::kNone || twin < he) continue;
+        if (dcel->Origin(he) == Dcel::kNone || dcel->Origin(twin) == Dcel::kNone) continue;
+        if (dcel->Site(he) == open_site || dcel->Site(twin) == open_site) continue;
+
+        // Go from the smaller endpoint to the bigger one, the face of a half-edge is on its right
+        geometry::Point orig = dcel->OriginPoint(he);
+        geometry::Point dest = dcel->OriginPoint(twin);
+        if (LexLess(dest, orig)) {
+            std::swap(he, twin);
+            std::swap(orig, dest);
+        }
+        double dx = dest.x - orig.x, dy = dest.y - orig.y;
+        if (dx == 0 && dy == 0) continue;
+        geometry::Point p = dcel->OriginOnBox(he) ? PointAtInfinity(orig, -dx, -dy) : orig;
+        geometry::Point q = dcel->OriginOnBox(twin) ? PointAtInfinity(orig, dx, dy) : dest;
+        segments.push_back({p, q, orig, dx, dy, dcel->Site(twin), dcel->Site(he)});
+    }
+    num_edges = segments.size();
+
+    // The first trapezoid is the whole plane
+    segments.push_back({{-kInf, 0, 0}, {kInf, 0, 0}, {0, kInf, 0}, 1, 0, open_site, open_site});
+    segments.push_back({{-kInf, 0, 0}, {kInf, 0, 0}, {0, -kInf, 0}, 1, 0, open_site, open_site});
+    int first = AddTrapezoid(num_edges, num_edges + 1, 2 * num_edges, 2 * num_edges + 1);
+    root = trapezoids[first].node;
+
+    // Random order keeps the expected size linear, a fixed seed keeps the answers reproducible
+    std::vector<int> order(num_edges);
+    for (int i = 0; i < num_edges; i++) {
+        order[i] = i;
+    }
+    std::mt19937 rng(num_edges);
+    std::shuffle(order.begin(), order.end(), rng);
+    for (int seg : order) {
+        Insert(seg);
+    }
+}
+
+int TrapezoidalMapLocator::Locate(geometry::Point pt) {
+    const Trapezoid& trap = trapezoids[FindTrapezoid(pt, pt, -1)];
+    if (trap.bottom < num_edges) return segments[trap.bottom].site_above;
+    if (trap.top < num_edges) return segments[trap.top].site_below;
+
+    // Nothing above or below happens only between vertical lines, take the face next to a wall
+    if (trap.leftp / 2 < num_edges) return segments[trap.leftp / 2].site_below;
+    if (trap.rightp / 2 < num_edges) return segments[trap.rightp / 2].site_above;
+    return 0;
+}
+
+void TrapezoidalMapLocator::Insert(int seg) {
+    const Segment& s = segments[seg];
+
+    // Find all trapezoids the segment crosses, from left to right
+    std::vector<Trapezoid> crossed = {trapezoids[FindTrapezoid(s.p, s.p, seg)]};
+    while (LexLess(Endpoint(crossed.back().rightp), s.q)) {
+        geometry::Point wall = Endpoint(crossed.back().rightp);
+        crossed.push_back(trapezoids[FindTrapezoid(wall, PointOnSegment(s, wall), seg)]);
+    }
+    int k = crossed.size();
+
+    // Parts left of 'p' and right of 'q', unless they are empty
+    int left = -1, right = -1;
+    if (LexLess(Endpoint(crossed[0].leftp), s.p)) {
+        left = AddTrapezoid(crossed[0].top, crossed[0].bottom, crossed[0].leftp, 2 * seg);
+    }
+    if (LexLess(s.q, Endpoint(crossed[k - 1].rightp))) {
+        right = AddTrapezoid(crossed[k - 1].top, crossed[k - 1].bottom, 2 * seg + 1, crossed[k - 1].rightp);
+    }
+
+    // Parts above and below the segment, a wall on the other side of the segment no longer splits them
+    std::vector<int> above(k), below(k);
+    int curr_above = AddTrapezoid(crossed[0].top, seg, 2 * seg, 2 * seg + 1);
+    int curr_below = AddTrapezoid(seg, crossed[0].bottom, 2 * seg, 2 * seg + 1);
+    for (int i = 0; i < k; i++) {
+        above[i] = curr_above;
+        below[i] = curr_below;
+        if (i == k - 1) break;
+        int wall = crossed[i].rightp;
+        if (Above(seg, Endpoint(wall), -1)) {
+            trapezoids[curr_above].rightp = wall;
+            curr_above = AddTrapezoid(crossed[i + 1].top, seg, wall, 2 * seg + 1);
+        } else {
+            trapezoids[curr_below].rightp = wall;
+            curr_below = AddTrapezoid(seg, crossed[i + 1].bottom, wall, 2 * seg + 1);
+        }
+    }
+
+    // Leaves of the crossed trapezoids turn into small subtrees
+    for (int i = 0; i < k; i++) {
+        int leaf = crossed[i].node;
+        int above_leaf = trapezoids[above[i]].node;
+        int below_leaf = trapezoids[below[i]].node;
+        bool has_left = (i == 0 && left != -1);
+        bool has_right = (i == k - 1 && right != -1);
+        if (!has_left && !has_right) {
+            nodes[leaf] = {Node::kSegment, seg, above_leaf, below_leaf};
+            continue;
+        }
+        int sub = AddNode(Node::kSegment, seg, above_leaf, below_leaf);
+        if (has_right && has_left) sub = AddNode(Node::kPoint, 2 * seg + 1, sub, trapezoids[right].node);
+        if (has_left) {
+            nodes[leaf] = {Node::kPoint, 2 * seg, trapezoids[left].node, sub};
+        } else {
+            nodes[leaf] = {Node::kPoint, 2 * seg + 1, sub, trapezoids[right].node};
+        }
+    }
+}
+
+int TrapezoidalMapLocator::FindTrapezoid(geometry::Point wall, geometry::Point on_seg, int seg) {
+    int curr = root;
+    while (nodes[curr].type != Node::kLeaf) {
+        const Node& node = nodes[curr];
+        if (node.type == Node::kPoint) {
+            // Points on the wall go right
+            curr = LexLess(wall, Endpoint(node.idx)) ? node.left : node.right;
+        } else {
+            curr = Above(node.idx, on_seg, seg) ? node.left : node.right;
+        }
+    }
+    return nodes[curr].idx;
+}
+
+bool TrapezoidalMapLocator::Above(int seg_idx, geometry::Point pt, int seg) {
+    const Segment& e = segments[seg_idx];
+
+    // Only the start of an inserted ray can be at infinity, compare the rays far to the left
+    if (std::isinf(pt.y)) return pt.y > 0;
+    if (std::isinf(pt.x)) {
+        const Segment& s = segments[seg];
+        double cross = e.dx * s.dy - e.dy * s.dx;
+        if (cross != 0) return cross < 0;
+        return e.dx * (s.anchor.y - e.anchor.y) - e.dy * (s.anchor.x - e.anchor.x) > 0;
+    }
+
+    double side = e.dx * (pt.y - e.anchor.y) - e.dy * (pt.x - e.anchor.x);
+    if (side != 0 || seg == -1) return side > 0;
+
+    // The point is on both segments, so they start there. Compare their directions
+    const Segment& s = segments[seg];
+    return e.dx * s.dy - e.dy * s.dx > 0;
+}
+
+geometry::Point TrapezoidalMapLocator::PointOnSegment(const Segment& s, geometry::Point wall) {
+    if (s.dx == 0) return {s.anchor.x, wall.y, 0};
+    return {wall.x, s.anchor.y + s.dy * (wall.x - s.anchor.x) / s.dx, 0};
+}
+
+int TrapezoidalMapLocator::AddTrapezoid(int top, int bottom, int leftp, int rightp) {
+    int trap = trapezoids.size();
+    trapezoids.push_back({top, bottom, leftp, rightp, AddNode(Node::kLeaf, trap, -1, -1)});
+    return trap;
+}
+
+int TrapezoidalMapLocator::AddNode(Node::Type type, int idx, int left, int right) {
+    nodes.push_back({type, idx, left, right});
+    return nodes.size() - 1;
+}
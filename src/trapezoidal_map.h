@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include "dcel.h"
+#include "geometry.h"
+#include "point_locator.h"
+
+// Point locator over a randomized incremental trapezoidal map (de Berg et al., Ch. 6)
+// Expected O(n log n) build, O(n) space and O(log n) queries
+// Points with equal x are ordered by y (a symbolic shear), so vertical edges and shared x need no special care
+// Edges that reach the box are rays, so points outside of the box are located too
+class TrapezoidalMapLocator : public PointLocator {
+   public:
+    // Preprocess a DCEL
+    void LoadDcel(Dcel* dcel) override;
+
+    // Answer a query: find a face that holds a given point
+    int Locate(geometry::Point pt) override;
+
+   private:
+    // An edge, 'p' comes before 'q' in the (x, y) order
+    // Endpoints of rays are at infinity, then 'anchor' and the direction still describe the line
+    struct Segment {
+        geometry::Point p, q;
+        geometry::Point anchor;  // A finite point of the segment
+        double dx, dy;           // Direction from 'p' to 'q'
+        int site_above;          // Site of the face above, or to the left if vertical
+        int site_below;
+    };
+
+    // A trapezoid between two segments and two vertical walls
+    struct Trapezoid {
+        int top, bottom;    // Segments
+        int leftp, rightp;  // Endpoints the walls go through, as 2 * segment + 0/1
+        int node;           // Leaf of the search structure
+    };
+
+    // A node of the search structure (a DAG)
+    struct Node {
+        enum Type { kPoint, kSegment, kLeaf } type;
+        int idx;          // Endpoint (as above), segment or trapezoid
+        int left, right;  // Children, for segments 'left' is above and 'right' is below
+    };
+
+    // Adds one segment to the map
+    void Insert(int seg);
+
+    // Finds the trapezoid holding a point. While inserting, 'on_seg' is the point of the inserted segment
+    // 'seg' where it crosses the wall at 'wall', and the trapezoid just right of the wall is returned
+    int FindTrapezoid(geometry::Point wall, geometry::Point on_seg, int seg);
+
+    // Checks if a point is above a segment, ties are broken by the direction of segment 'seg' (if any)
+    bool Above(int seg_idx, geometry::Point pt, int seg);
+
+    // The point of a segment on the wall through 'wall'
+    geometry::Point PointOnSegment(const Segment& s, geometry::Point wall);
+
+    int AddTrapezoid(int top, int bottom, int leftp, int rightp);
+    int AddNode(Node::Type type, int idx, int left, int right);
+    geometry::Point Endpoint(int idx) { return (idx % 2 == 0) ? segments[idx / 2].p : segments[idx / 2].q; }
+
+    // Edges come first, then two sentinels above and below everything
+    int num_edges;
+    std::vector<Segment> segments;
+    std::vector<Trapezoid> trapezoids;
+    std::vector<Node> nodes;
+    int root;
+};
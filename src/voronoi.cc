@@ -1,50 +1,53 @@
 #include "voronoi.h"
+#include "predicates.h"
 #include "voronoi_utils.h"
 
+#include <algorithm>
 #include <cassert>
 
 Voronoi::Voronoi(Model* model) : model(model) {
     sites = model->GetPoints();
     beach_line.SetSites(sites);
+    beach_line.SetDcel(model->GetVoronoiDcel());
     dcel = model->GetVoronoiDcel();
-    draw_beach_line = true;
+    tracer = model->GetTraceDir().empty() ? nullptr : new TraceWriter(model->GetTraceDir());
 }
 
-std::future<void> Voronoi::ComputeDiagram() { return std::async(std::launch::async, &Voronoi::Fortunes, this); }
+Voronoi::~Voronoi() { delete tracer; }
 
-CircleEvent* Voronoi::DetectCircleEvent(LeafNode* a, LeafNode* b, LeafNode* c, double sw_y) {
+std::future<void> Voronoi::ComputeDiagram(std::launch policy) { return std::async(policy, &Voronoi::Fortunes, this); }
+
+bool Voronoi::DetectCircleEvent(LeafNode* a, LeafNode* b, LeafNode* c, double sw_y, const CircleEvent* handled,
+                               int handled_site) {
     if (a->GetSite() == c->GetSite() || sites[b->GetSite()].y == sw_y) {
-        return nullptr;
+        return false;
     }
+    const geometry::Point& pa = sites[a->GetSite()];
+    const geometry::Point& pb = sites[b->GetSite()];
+    const geometry::Point& pc = sites[c->GetSite()];
 
-    // Find parabola intersections and check the distance
-    geometry::Point ab = geometry::FindParabolaIntersection(sites[a->GetSite()], sites[b->GetSite()], sw_y);
-    geometry::Point bc = geometry::FindParabolaIntersection(sites[b->GetSite()], sites[c->GetSite()], sw_y);
-    double dist = geometry::Dist(ab, bc);
-    if (dist <= 1e-6) {
-        return new CircleEvent(sw_y, ab, nullptr);  // Arc will be filled later
+    // The breakpoints only converge if the turn is right, collinear or left turns have no circle event
+    if (geometry::Turn(pa, pb, pc) != -1) {
+        return false;
     }
 
-    // Collinear, no circle event
-    if (geometry::Turn(sites[a->GetSite()], sites[b->GetSite()], sites[c->GetSite()]) == 0) {
-        return nullptr;
+    // Cocircular with the arc that was just removed: the same vertex, right now
+    if (handled != nullptr && geometry::InCircle(pa, pb, pc, sites[handled_site]) == 0) {
+        b->SetCircleEvent(event_queue.AddCircleEvent(CircleEvent(handled->GetY(), handled->GetCenter(), b)));
+        return true;
     }
 
-    // There is potentially a circle event, find the circle
-    geometry::Point center = geometry::FindCircumcenter(sites[a->GetSite()], sites[b->GetSite()], sites[c->GetSite()]);
-    double radius = geometry::Dist(sites[a->GetSite()], center);
-    double bottom_y = center.y - radius;
-
-    // Check if the turns are right and the circle is not too high
-    if (bottom_y >= sw_y) {
-        return nullptr;
-    }
-    if (geometry::Turn(sites[a->GetSite()], sites[b->GetSite()], sites[c->GetSite()]) == 1) {
-        return nullptr;
+    // The circle's lowest point, where the event happens, can't be above the sweep line. When it's on it the
+    // computed one is clamped, so the event isn't queued in the past
+    if (geometry::CircleBottom(pa, pb, pc, sw_y) > 0) {
+        return false;
     }
+    geometry::Point center = geometry::FindCircumcenter(pa, pb, pc);
+    double bottom_y = std::min(center.y - geometry::Dist(pa, center), sw_y);
 
     // We have a new circle event
-    return new CircleEvent(bottom_y, center, nullptr);
+    b->SetCircleEvent(event_queue.AddCircleEvent(CircleEvent(bottom_y, center, b)));
+    return true;
 }
 
 void Voronoi::HandleInitialSiteEvent(const SiteEvent& event) {
@@ -57,33 +60,26 @@ void Voronoi::HandleInitialSiteEvent(const SiteEvent& event) {
     // Start tracing a new halfedge vertically to infinity
     geometry::Line line = geometry::Bisector(sites[event.GetSite()], sites[first_leaf->GetSite()]);
     line.dir = 'u';
-    Dcel::HalfEdge* up = new Dcel::HalfEdge();
-    Dcel::HalfEdge* down = new Dcel::HalfEdge();
-    up->line = down->line = line;
-    dcel->half_edges.push_back(up);
-    dcel->half_edges.push_back(down);
-    up->twin = down;
-    down->twin = up;
+    std::pair<int, int> edge = dcel->AddEdge();
+    int up = edge.first, down = edge.second;
+    dcel->half_edges[up].line = dcel->half_edges[down].line = line;
     beach_line.InitialInsert(event.GetSite(), up);
 }
 
 void Voronoi::HandleSiteEvent(const SiteEvent& event) {
     LeafNode* arc_above = beach_line.FindArcAbove(sites[event.GetSite()].x, sites[event.GetSite()].y);
 
-    if (arc_above->GetCircleEvent() != nullptr) {
-        // False alarm
-        arc_above->GetCircleEvent()->SetFalseAlarm(true);
+    if (arc_above->GetCircleEvent() != EventQueue::kNone) {
+        // False alarm, the arc is about to be split
+        event_queue.RemoveCircleEvent(arc_above->GetCircleEvent());
+        arc_above->SetCircleEvent(EventQueue::kNone);
     }
 
     // Start tracing a new half-edge
-    Dcel::HalfEdge* upper = new Dcel::HalfEdge();
-    Dcel::HalfEdge* lower = new Dcel::HalfEdge();
+    std::pair<int, int> edge = dcel->AddEdge();
+    int upper = edge.first, lower = edge.second;
     geometry::Line line = geometry::Bisector(sites[event.GetSite()], sites[arc_above->GetSite()]);
-    upper->line = lower->line = line;
-    dcel->half_edges.push_back(upper);
-    dcel->half_edges.push_back(lower);
-    upper->twin = lower;
-    lower->twin = upper;
+    dcel->half_edges[upper].line = dcel->half_edges[lower].line = line;
 
     // Detect new circle events
     LeafNode* node = beach_line.Insert(arc_above, event.GetSite(), upper, lower);
@@ -92,41 +88,25 @@ void Voronoi::HandleSiteEvent(const SiteEvent& event) {
     LeafNode* far_left = beach_line.FindPred(left);
     LeafNode* far_right = beach_line.FindSucc(right);
     if (far_left != nullptr) {
-        CircleEvent* circle_event = DetectCircleEvent(far_left, left, node, event.GetY());
-        if (circle_event != nullptr) {
-            circle_event->SetArc(left);
-            left->SetCircleEvent(circle_event);
-            event_queue.push(circle_event);
-        }
+        DetectCircleEvent(far_left, left, node, event.GetY());
     }
     if (far_right != nullptr) {
-        CircleEvent* circle_event = DetectCircleEvent(node, right, far_right, event.GetY());
-        if (circle_event != nullptr) {
-            circle_event->SetArc(right);
-            right->SetCircleEvent(circle_event);
-            event_queue.push(circle_event);
-        }
+        DetectCircleEvent(node, right, far_right, event.GetY());
     }
 }
 
-void Voronoi::RefreshCircleEvent(LeafNode* arc, double sw_y) {
-    // If there is a circle event mark it as a false alarm
-    if (arc->GetCircleEvent() != nullptr) {
-        arc->GetCircleEvent()->SetFalseAlarm(true);
-        arc->GetCircleEvent()->SetArc(nullptr);
-        arc->SetCircleEvent(nullptr);
+void Voronoi::RefreshCircleEvent(LeafNode* arc, double sw_y, const CircleEvent* handled, int handled_site) {
+    // If there is a circle event it's a false alarm, drop it from the queue
+    if (arc->GetCircleEvent() != EventQueue::kNone) {
+        event_queue.RemoveCircleEvent(arc->GetCircleEvent());
+        arc->SetCircleEvent(EventQueue::kNone);
     }
 
     // Find an new circle event
     LeafNode* pred = beach_line.FindPred(arc);
     LeafNode* succ = beach_line.FindSucc(arc);
     if (pred == nullptr || succ == nullptr) return;
-    CircleEvent* circle_event = DetectCircleEvent(pred, arc, succ, sw_y);
-    if (circle_event != nullptr) {
-        circle_event->SetArc(arc);
-        arc->SetCircleEvent(circle_event);
-        event_queue.push(circle_event);
-    }
+    DetectCircleEvent(pred, arc, succ, sw_y, handled, handled_site);
 }
 
 void Voronoi::HandleCircleEvent(const CircleEvent& event) {
@@ -134,8 +114,7 @@ void Voronoi::HandleCircleEvent(const CircleEvent& event) {
     int site = event.GetArc()->GetSite();
 
     // We found a new DCEL vertex
-    Dcel::Vertex* vertex = new Dcel::Vertex(event.GetCenter());
-    dcel->vertices.push_back(vertex);
+    int vertex = dcel->AddVertex(event.GetCenter());
 
     // Find pred succ for circle event adding later
     LeafNode* pred = beach_line.FindPred(event.GetArc());
@@ -145,44 +124,43 @@ void Voronoi::HandleCircleEvent(const CircleEvent& event) {
     }
 
     // Start tracing a new edge down
-    Dcel::HalfEdge* down = new Dcel::HalfEdge();
-    Dcel::HalfEdge* up = new Dcel::HalfEdge();
+    std::pair<int, int> edge = dcel->AddEdge();
+    int down = edge.first, up = edge.second;
     geometry::Line line = geometry::Bisector(sites[pred->GetSite()], sites[succ->GetSite()]);
-    up->line = down->line = line;
-    down->origin = vertex;
-    down->incident_face = dcel->faces[pred->GetSite()];
-    up->incident_face = dcel->faces[succ->GetSite()];
-    vertex->incident_halfedge = down;
-    down->twin = up;
-    up->twin = down;
-    dcel->half_edges.push_back(down);
-    dcel->half_edges.push_back(up);
+    std::vector<Dcel::HalfEdge>& he = dcel->half_edges;
+    he[up].line = he[down].line = line;
+    he[down].origin = vertex;
+    he[down].incident_face = pred->GetSite();
+    he[up].incident_face = succ->GetSite();
+    dcel->vertices[vertex].incident_halfedge = down;
 
     // Delete from the beach line
-    std::pair<Dcel::HalfEdge*, Dcel::HalfEdge*> edges = beach_line.Delete(event.GetArc(), up);
+    std::pair<int, int> edges = beach_line.Delete(event.GetArc(), up);
 
     // Refresh circle events where neighbourhood changed
-    RefreshCircleEvent(pred, event.GetY());
-    RefreshCircleEvent(succ, event.GetY());
+    RefreshCircleEvent(pred, event.GetY(), &event, site);
+    RefreshCircleEvent(succ, event.GetY(), &event, site);
 
     // Set origins and incident faces
-    edges.first->origin = vertex;
-    edges.first->incident_face = dcel->faces[site];
-    edges.first->twin->incident_face = dcel->faces[pred->GetSite()];
+    int fst = edges.first, fst_twin = he[fst].twin;
+    int snd = edges.second, snd_twin = he[snd].twin;
+    he[fst].origin = vertex;
+    he[fst].incident_face = site;
+    he[fst_twin].incident_face = pred->GetSite();
 
-    edges.second->origin = vertex;
-    edges.second->incident_face = dcel->faces[succ->GetSite()];
-    edges.second->twin->incident_face = dcel->faces[site];
+    he[snd].origin = vertex;
+    he[snd].incident_face = succ->GetSite();
+    he[snd_twin].incident_face = site;
 
     // Set next and prev pointrs
-    edges.first->prev = edges.second->twin;
-    edges.second->twin->next = edges.first;
+    he[fst].prev = snd_twin;
+    he[snd_twin].next = fst;
 
-    edges.second->prev = up;
-    up->next = edges.second;
+    he[snd].prev = up;
+    he[up].next = snd;
 
-    down->prev = edges.first->twin;
-    edges.first->twin->next = down;
+    he[down].prev = fst_twin;
+    he[fst_twin].next = down;
 }
 
 void Voronoi::ProcessAllCollinear() {
@@ -207,94 +185,86 @@ void Voronoi::ProcessAllCollinear() {
         for (int i = 0; i < sz - 1; i++) {
             // Add a new vertex and four new edges
             geometry::Point mid = geometry::Midpoint(sites[i], sites[i + 1]);
-            Dcel::Vertex* v = new Dcel::Vertex(mid);
-            dcel->vertices.push_back(v);
-            Dcel::HalfEdge* upper_up = new Dcel::HalfEdge();
-            Dcel::HalfEdge* upper_down = new Dcel::HalfEdge();
-            Dcel::HalfEdge* lower_up = new Dcel::HalfEdge();
-            Dcel::HalfEdge* lower_down = new Dcel::HalfEdge();
-            dcel->half_edges.push_back(upper_up);
-            dcel->half_edges.push_back(upper_down);
-            dcel->half_edges.push_back(lower_up);
-            dcel->half_edges.push_back(lower_down);
+            int v = dcel->AddVertex(mid);
+            std::pair<int, int> upper = dcel->AddEdge();
+            std::pair<int, int> lower = dcel->AddEdge();
+            int upper_up = upper.first, upper_down = upper.second;
+            int lower_up = lower.first, lower_down = lower.second;
+            std::vector<Dcel::HalfEdge>& he = dcel->half_edges;
 
             // Set origin pointers
-            upper_up->origin = v;
-            lower_down->origin = v;
+            he[upper_up].origin = v;
+            he[lower_down].origin = v;
 
-            // Set twin/next/prev pointers
-            v->incident_halfedge = upper_up;
-            upper_up->twin = upper_down, upper_down->twin = upper_up;
-            lower_up->twin = lower_down, lower_down->twin = lower_up;
-            lower_up->next = upper_up, upper_up->prev = lower_up;
-            upper_down->next = lower_down, lower_down->prev = upper_down;
+            // Set next/prev pointers, twins are already set
+            dcel->vertices[v].incident_halfedge = upper_up;
+            he[lower_up].next = upper_up, he[upper_up].prev = lower_up;
+            he[upper_down].next = lower_down, he[lower_down].prev = upper_down;
 
             // Set incident faces
-            upper_up->incident_face = dcel->faces[sites[i + 1].idx];
-            lower_up->incident_face = dcel->faces[sites[i + 1].idx];
-            upper_down->incident_face = dcel->faces[sites[i].idx];
-            lower_down->incident_face = dcel->faces[sites[i].idx];
+            he[upper_up].incident_face = sites[i + 1].idx;
+            he[lower_up].incident_face = sites[i + 1].idx;
+            he[upper_down].incident_face = sites[i].idx;
+            he[lower_down].incident_face = sites[i].idx;
 
             // Add the line
             geometry::Line bis = geometry::Bisector(sites[i], sites[i + 1]);
             if (bis.vertical) {
                 bis.dir = 'u';
-                upper_up->line = bis;
-                upper_down->line = bis;
+                he[upper_up].line = bis;
+                he[upper_down].line = bis;
                 bis.dir = 'd';
-                lower_up->line = bis;
-                lower_down->line = bis;
+                he[lower_up].line = bis;
+                he[lower_down].line = bis;
             } else {
                 char fst = (sites[i].y < sites[i + 1].y) ? 'l' : 'r';
                 char snd = (fst == 'l') ? 'r' : 'l';
                 bis.dir = fst;
-                upper_up->line = bis;
-                upper_down->line = bis;
+                he[upper_up].line = bis;
+                he[upper_down].line = bis;
                 bis.dir = snd;
-                lower_up->line = bis;
-                lower_down->line = bis;
+                he[lower_up].line = bis;
+                he[lower_down].line = bis;
             }
         }
     }
 }
 
 void Voronoi::ProcessEvents() {
-    // Add site event to the event queue
-    double max_y = sites[0].y;
-    int sz = sites.size();
-    for (int i = 0; i < sz; i++) {
-        SiteEvent* event = new SiteEvent(sites[i].x, sites[i].y, i);
-        event_queue.push(event);
-        max_y = std::max(max_y, sites[i].y);
-    }
+    // Sort the site events, the first one is the highest
+    event_queue.Init(sites, model->GetPointSetInfo().sweep_sorted);
+    double max_y = event_queue.NextY();
 
     // Main event loop
     int events_done = 0;
-    while (!event_queue.empty()) {
-        Event* event = event_queue.top();
-        model->SetSweepY(event->GetY());
-        event_queue.pop();
+    int last_site = -1;
+    while (!event_queue.Empty()) {
+        model->SetSweepY(event_queue.NextY());
         {
             std::lock_guard<std::mutex> lock(*(model->GetMutex()));
-            if (model->GetSweepY() == max_y) {
-                // This is a site event but the line never moved
-                HandleInitialSiteEvent(*(static_cast<SiteEvent*>(event)));
-            } else if (event->GetType() == 's') {
-                // This is a site event
-                HandleSiteEvent(*(static_cast<SiteEvent*>(event)));
-            } else {
-                // This is a circle event, we will discard it if it's a false alarm
-                CircleEvent* circle_event = static_cast<CircleEvent*>(event);
-                if (circle_event->GetFalseAlarm() == false) {
-                    HandleCircleEvent(*circle_event);
+            if (event_queue.NextType() == 's') {
+                SiteEvent event = event_queue.PopSiteEvent();
+                const geometry::Point& site = sites[event.GetSite()];
+                bool duplicate = last_site != -1 && sites[last_site].x == site.x && sites[last_site].y == site.y;
+                last_site = event.GetSite();
+                if (duplicate) {
+                    // Same as the last site, which already has the whole cell, so its face stays empty
+                } else if (model->GetSweepY() == max_y) {
+                    // This is a site event but the line never moved
+                    HandleInitialSiteEvent(event);
+                } else {
+                    HandleSiteEvent(event);
                 }
+            } else {
+                // This is a circle event, stale ones were already removed
+                HandleCircleEvent(event_queue.PopCircleEvent());
             }
         }
-        delete event;
         events_done++;
 
-        // Draw the beach line BST after each iteration
-        beach_line.Draw("out/" + std::to_string(events_done));
+        // Trace the beach line BST after each iteration, the files are written in the background
+        if (tracer != nullptr) tracer->Add(std::to_string(events_done), beach_line.ToDot());
+        model->GetVoronoiPacer()->Step();
     }
 
     {
@@ -306,19 +276,22 @@ void Voronoi::ProcessEvents() {
 }
 
 void Voronoi::Fortunes() {
+    auto start = std::chrono::steady_clock::now();
+    StageTimes* times = model->GetStageTimes();
+
     // Add faces to DCEL
     int sz = sites.size();
     {
         std::lock_guard<std::mutex> lock(*(model->GetMutex()));
         for (int i = 0; i < sz; i++) {
-            dcel->faces.push_back(new Dcel::Face(i));
+            dcel->AddFace(i);
         }
-        open_face = new Dcel::Face(sz);
-        dcel->faces.push_back(open_face);  // outer face
+        open_face = dcel->AddFace(sz);  // outer face
     }
 
     // Process
-    if (geometry::AllCollinear(sites)) {
+    const geometry::PointSetInfo& info = model->GetPointSetInfo();
+    if (geometry::AllCollinear(sites, info)) {
         ProcessAllCollinear();
     } else {
         ProcessEvents();
@@ -328,24 +301,28 @@ void Voronoi::Fortunes() {
         std::lock_guard<std::mutex> lock(*(model->GetMutex()));
 
         // Add a bounding box around the diagram
-        Dcel::HalfEdge* open_edge;
-        open_edge = voronoi_utils::AddBox(sites, open_face, dcel);
+        auto box_start = std::chrono::steady_clock::now();
+        int open_edge = voronoi_utils::AddBox(sites, open_face, dcel, info.has_box ? &info.box : nullptr);
+        times->voronoi_box = SecondsSince(box_start);
 
         // Move the sweep line to its final position
-        for (auto v : dcel->vertices) {
-            model->SetSweepY(std::min(model->GetSweepY(), v->point.y - 10));
+        for (const Dcel::Vertex& v : dcel->vertices) {
+            model->SetSweepY(std::min(model->GetSweepY(), v.point.y - 10));
         }
 
         // Add inner/outer component pointers
-        for (Dcel::HalfEdge* he : dcel->half_edges) {
-            Dcel::Face* face = he->incident_face;
-            if (face != open_face && face->outer_component == nullptr) {
-                face->outer_component = open_edge;
-                open_face->inner_components.push_back(he);
+        int he_sz = dcel->half_edges.size();
+        for (int he = 0; he < he_sz; he++) {
+            Dcel::Face& face = dcel->faces[dcel->half_edges[he].incident_face];
+            if (dcel->half_edges[he].incident_face != open_face && face.outer_component == Dcel::kNone) {
+                face.outer_component = open_edge;
+                dcel->faces[open_face].inner_components.push_back(he);
             }
         }
     }
 
+    times->fortune = SecondsSince(start) - times->voronoi_box;
+
     // TODO: If a Voronoi vertex is incident to four faces, merge two DCEL vertices with same coordinates
-    printf("Voronoi diagram found!\n");
+    if (model->GetVisualize()) printf("Voronoi diagram found!\n");
 }
\ No newline at end of file
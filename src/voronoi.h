@@ -1,29 +1,34 @@
 #pragma once
-#include <queue>
+#include <future>
 #include <vector>
 #include "beach_line.h"
 #include "dcel.h"
 #include "event.h"
 #include "geometry.h"
 #include "model.h"
+#include "trace_writer.h"
 
 class Voronoi {
    public:
     Voronoi(Model* model);
+    ~Voronoi();
 
-    // Compute the diagram in a new thread
-    std::future<void> ComputeDiagram();
+    // Compute the diagram in a new thread (or lazily, on get(), if deferred)
+    std::future<void> ComputeDiagram(std::launch policy = std::launch::async);
 
    private:
     // Find a circle event defined by arcs (a, b, c) for a fixed sweep line position
-    CircleEvent* DetectCircleEvent(LeafNode* a, LeafNode* b, LeafNode* c, double sw_y);
+    // If there is one, queue it and anchor it at b. While handling the circle event 'handled', whose arc of
+    // 'handled_site' was removed, a cocircular (a, b, c) gets the same vertex
+    bool DetectCircleEvent(LeafNode* a, LeafNode* b, LeafNode* c, double sw_y, const CircleEvent* handled = nullptr,
+                           int handled_site = -1);
 
     // Handle site events
     void HandleInitialSiteEvent(const SiteEvent& event);
     void HandleSiteEvent(const SiteEvent& event);
 
     // Delete the circle event anchored at an arc if it's stale and create a new one
-    void RefreshCircleEvent(LeafNode* arc, double sw_y);
+    void RefreshCircleEvent(LeafNode* arc, double sw_y, const CircleEvent* handled = nullptr, int handled_site = -1);
 
     // Handle circle events
     void HandleCircleEvent(const CircleEvent& event);
@@ -40,18 +45,13 @@ class Voronoi {
     // Model
     Model* model;
 
-    struct Cmp {
-        bool operator()(Event* arg1, Event* arg2) {
-            return *arg1 < *arg2;  // Decreasing y
-        }
-    };
-    std::priority_queue<Event*, std::vector<Event*>, Cmp> event_queue;
+    EventQueue event_queue;
     BeachLine beach_line;
-    Dcel::Face* open_face;  // Unbounded face
+    int open_face;  // Unbounded face
     std::vector<geometry::Point> sites;
     Dcel* dcel;
 
     // If set, will save a graphviz graph representation of the
     // beach line BST after each Fortune's step
-    double draw_beach_line;
+    TraceWriter* tracer;
 };
\ No newline at end of file
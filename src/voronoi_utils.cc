@@ -2,18 +2,24 @@
 
 #include <algorithm>
 #include <cmath>
+#include <map>
 
-Dcel::HalfEdge* voronoi_utils::AddBox(const std::vector<geometry::Point>& sites, Dcel::Face* open_face, Dcel* dcel) {
+int voronoi_utils::AddBox(const std::vector<geometry::Point>& sites, int open_face, Dcel* dcel,
+                          const geometry::Rect* site_box) {
     // Calculate box vertices
     geometry::Rect box({sites[0].x, sites[0].x, sites[0].y, sites[0].y});
-    for (auto site : sites) {
-        box.x1 = std::min(box.x1, site.x);
-        box.y1 = std::min(box.y1, site.y);
-        box.x2 = std::max(box.x2, site.x);
-        box.y2 = std::max(box.y2, site.y);
+    if (site_box != nullptr) {
+        box = *site_box;
+    } else {
+        for (auto site : sites) {
+            box.x1 = std::min(box.x1, site.x);
+            box.y1 = std::min(box.y1, site.y);
+            box.x2 = std::max(box.x2, site.x);
+            box.y2 = std::max(box.y2, site.y);
+        }
     }
-    for (auto vertex : dcel->vertices) {
-        const geometry::Point& site = vertex->point;
+    for (const Dcel::Vertex& vertex : dcel->vertices) {
+        const geometry::Point& site = vertex.point;
         box.x1 = std::min(box.x1, site.x);
         box.y1 = std::min(box.y1, site.y);
         box.x2 = std::max(box.x2, site.x);
@@ -30,91 +36,98 @@ Dcel::HalfEdge* voronoi_utils::AddBox(const std::vector<geometry::Point>& sites,
     box.y1 -= y_diff / 2, box.y2 += y_diff / 2;
 
     // Create new vertices
-    std::vector<Dcel::Vertex*> box_verts;
-    box_verts.push_back(new Dcel::Vertex({box.x1, box.y1, 0}, true));
-    box_verts.push_back(new Dcel::Vertex({box.x2, box.y2, 0}, true));
-    box_verts.push_back(new Dcel::Vertex({box.x1, box.y2, 0}, true));
-    box_verts.push_back(new Dcel::Vertex({box.x2, box.y1, 0}, true));
+    std::vector<int> box_verts;
+    box_verts.push_back(dcel->AddVertex({box.x1, box.y1, 0}, true));
+    box_verts.push_back(dcel->AddVertex({box.x2, box.y2, 0}, true));
+    box_verts.push_back(dcel->AddVertex({box.x1, box.y2, 0}, true));
+    box_verts.push_back(dcel->AddVertex({box.x2, box.y1, 0}, true));
+
+    // Box vertices by coordinates, so that duplicates are found without a linear scan
+    std::map<std::pair<double, double>, int> box_vert_at;
+    for (int vert : box_verts) {
+        box_vert_at[{dcel->vertices[vert].point.x, dcel->vertices[vert].point.y}] = vert;
+    }
 
     // Find all edges with no origin and intersect them with the box
-    for (auto edge : dcel->half_edges) {
-        if ((edge->twin->origin) == nullptr) {
-            geometry::Point inter = geometry::RectHalfLineIntersection(box, edge->line, edge->origin->point);
+    int he_sz = dcel->half_edges.size();
+    for (int edge = 0; edge < he_sz; edge++) {
+        int twin = dcel->Twin(edge);
+        if (dcel->Origin(twin) == Dcel::kNone) {
+            geometry::Point inter =
+                geometry::RectHalfLineIntersection(box, dcel->half_edges[edge].line, dcel->OriginPoint(edge));
 
             // Intersection gives a new vertex
-            Dcel::Vertex* vert = new Dcel::Vertex(inter, true);
-            bool new_vert = true;
-            for (auto vert2 : box_verts) {
-                if (vert2->point.x == vert->point.x && vert2->point.y == vert->point.y) {
-                    vert = vert2;
-                    new_vert = false;
-                    break;
-                }
+            int vert;
+            auto it = box_vert_at.find({inter.x, inter.y});
+            if (it != box_vert_at.end()) {
+                vert = it->second;
+            } else {
+                vert = dcel->AddVertex(inter, true);
+                box_verts.push_back(vert);
+                box_vert_at[{inter.x, inter.y}] = vert;
             }
-            edge->twin->origin = vert;
-            vert->incident_halfedge = edge->twin;
-            if (new_vert) box_verts.push_back(vert);
+            dcel->half_edges[twin].origin = vert;
+            dcel->vertices[vert].incident_halfedge = twin;
         }
     }
 
     // Circular sort of box vertices
     geometry::Point mid = {(box.x1 + box.x2) / 2, (box.y1 + box.y2) / 2, 0};
-    std::sort(box_verts.begin(), box_verts.end(), [mid](const Dcel::Vertex* a, const Dcel::Vertex* b) {
-        double ang_a = atan2(mid.y - a->point.y, mid.x - a->point.x);
-        double ang_b = atan2(mid.y - b->point.y, mid.x - b->point.x);
+    std::sort(box_verts.begin(), box_verts.end(), [mid, dcel](int a, int b) {
+        const geometry::Point& pa = dcel->vertices[a].point;
+        const geometry::Point& pb = dcel->vertices[b].point;
+        double ang_a = atan2(mid.y - pa.y, mid.x - pa.x);
+        double ang_b = atan2(mid.y - pb.y, mid.x - pb.x);
         return ang_a > ang_b;
     });
 
     // Do one full circle and create edges
     int sz = box_verts.size();
-    std::vector<Dcel::HalfEdge*> fwds;
-    std::vector<Dcel::HalfEdge*> bwds;
+    std::vector<int> fwds;
+    std::vector<int> bwds;
     for (int i = 0; i < sz; i++) {
-        fwds.push_back(new Dcel::HalfEdge());
-        bwds.push_back(new Dcel::HalfEdge());
+        std::pair<int, int> edge = dcel->AddEdge();
+        fwds.push_back(edge.first);
+        bwds.push_back(edge.second);
     }
 
     // Connect box edges
+    std::vector<Dcel::HalfEdge>& he = dcel->half_edges;
+    std::vector<Dcel::Vertex>& verts = dcel->vertices;
     for (int i = 0; i < sz; i++) {
-        // Add vertex to DCEL
-        dcel->vertices.push_back(box_verts[i]);
         int i_nxt = (i + 1) % sz;
         int i_prev = (i + sz - 1) % sz;
 
-        // Add edges to DCEL
-        Dcel::HalfEdge* fwd = fwds[i];
-        Dcel::HalfEdge* bwd = bwds[i];
-        dcel->half_edges.push_back(fwd);
-        dcel->half_edges.push_back(bwd);
-
-        // Set twin and origin pointers
-        fwd->twin = bwd, bwd->twin = fwd;
-        fwd->origin = box_verts[i];
-        bwd->origin = box_verts[i_nxt];
+        // Set origin pointers, twins are already set
+        int fwd = fwds[i];
+        int bwd = bwds[i];
+        he[fwd].origin = box_verts[i];
+        he[bwd].origin = box_verts[i_nxt];
 
         // Set incident_face pointers
-        bwd->incident_face = open_face;
+        he[bwd].incident_face = open_face;
         int idx = i;
-        while (box_verts[idx]->incident_halfedge == nullptr) {
+        while (verts[box_verts[idx]].incident_halfedge == Dcel::kNone) {
             idx = (idx + sz - 1) % sz;
         }
-        fwd->incident_face = box_verts[idx]->incident_halfedge->twin->incident_face;
+        he[fwd].incident_face = he[dcel->Twin(verts[box_verts[idx]].incident_halfedge)].incident_face;
 
         // Set next and prev pointers
-        bwds[i_prev]->prev = bwds[i];
-        bwds[i]->next = bwds[i_prev];
-        if (box_verts[i]->incident_halfedge == nullptr) {
+        he[bwds[i_prev]].prev = bwds[i];
+        he[bwds[i]].next = bwds[i_prev];
+        int incident = verts[box_verts[i]].incident_halfedge;
+        if (incident == Dcel::kNone) {
             // Corner, special case
-            fwds[i]->prev = fwds[i_prev];
-            fwds[i_prev]->next = fwds[i];
-            box_verts[i]->incident_halfedge = fwds[i];
+            he[fwds[i]].prev = fwds[i_prev];
+            he[fwds[i_prev]].next = fwds[i];
+            verts[box_verts[i]].incident_halfedge = fwds[i];
         } else {
             // Not a corner
-            fwds[i]->prev = box_verts[i]->incident_halfedge->twin;
-            box_verts[i]->incident_halfedge->twin->next = fwds[i];
+            he[fwds[i]].prev = dcel->Twin(incident);
+            he[dcel->Twin(incident)].next = fwds[i];
 
-            fwds[i_prev]->next = box_verts[i]->incident_halfedge;
-            box_verts[i]->incident_halfedge->prev = fwds[i_prev];
+            he[fwds[i_prev]].next = incident;
+            he[incident].prev = fwds[i_prev];
         }
     }
     // A half-edge incident to open_face
@@ -6,6 +6,8 @@
 namespace voronoi_utils {
 
 // Adds a bounding box around a diagram given in a DCEL, open_face is the unbounded face
-Dcel::HalfEdge* AddBox(const std::vector<geometry::Point>& sites, Dcel::Face* open_face, Dcel* dcel);
+// Returns a half-edge incident to open_face. If the bounding box of the sites is given, they aren't scanned
+int AddBox(const std::vector<geometry::Point>& sites, int open_face, Dcel* dcel,
+           const geometry::Rect* site_box = nullptr);
 
 }  // namespace voronoi_utils
\ No newline at end of file
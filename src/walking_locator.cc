@@ -0,0 +1,101 @@
+#include "walking_locator.h"
+
+#include <algorithm>
+#include <cstdint>
+
+const int WalkingLocator::kMaxEdges;
+
+WalkingLocator::WalkingLocator(PointLocator* fallback) { this->fallback = fallback; }
+
+WalkingLocator::~WalkingLocator() { delete fallback; }
+
+void WalkingLocator::LoadDcel(Dcel* dcel) {
+    fallback->LoadDcel(dcel);
+    this->dcel = dcel;
+    open_face = dcel->faces.size() - 1;
+
+    int face_sz = dcel->faces.size();
+    face_edge.assign(face_sz, Dcel::kNone);
+    site_face.assign(face_sz, Dcel::kNone);
+    for (int face = 0; face < face_sz; face++) {
+        int site = dcel->faces[face].site;
+        if (site >= 0 && site < face_sz) site_face[site] = face;
+    }
+    int he_sz = dcel->half_edges.size();
+    for (int he = 0; he < he_sz; he++) {
+        if (dcel->Live(he) == Dcel::kNone || dcel->Origin(he) == Dcel::kNone) continue;
+        int face = dcel->half_edges[he].incident_face;
+        if (face != Dcel::kNone && face_edge[face] == Dcel::kNone) face_edge[face] = he;
+    }
+}
+
+int WalkingLocator::Locate(geometry::Point pt) { return fallback->Locate(pt); }
+
+int WalkingLocator::LocateFrom(geometry::Point pt, int hint) {
+    int face = (hint >= 0 && hint < static_cast<int>(site_face.size())) ? site_face[hint] : Dcel::kNone;
+    if (face != Dcel::kNone) face = Walk(pt, face);
+    return (face == Dcel::kNone) ? fallback->Locate(pt) : dcel->faces[face].site;
+}
+
+void WalkingLocator::SortQueries(const geometry::Point* pts, std::vector<int>* order) {
+    int n = order->size();
+    if (n == 0) return;
+
+    // Interleave the bits of both coordinates on a 2^16 x 2^16 grid over the queries
+    double x1 = pts[0].x, x2 = pts[0].x, y1 = pts[0].y, y2 = pts[0].y;
+    for (int i = 0; i < n; i++) {
+        x1 = std::min(x1, pts[i].x);
+        x2 = std::max(x2, pts[i].x);
+        y1 = std::min(y1, pts[i].y);
+        y2 = std::max(y2, pts[i].y);
+    }
+    double scale_x = (x2 > x1) ? 65535 / (x2 - x1) : 0;
+    double scale_y = (y2 > y1) ? 65535 / (y2 - y1) : 0;
+    std::vector<uint32_t> keys(n);
+    for (int i = 0; i < n; i++) {
+        uint32_t cx = (pts[i].x - x1) * scale_x;
+        uint32_t cy = (pts[i].y - y1) * scale_y;
+        uint32_t key = 0;
+        for (int bit = 0; bit < 16; bit++) {
+            key |= ((cx >> bit) & 1) << (2 * bit);
+            key |= ((cy >> bit) & 1) << (2 * bit + 1);
+        }
+        keys[i] = key;
+    }
+    std::sort(order->begin(), order->end(),
+              [&keys](int a, int b) { return keys[a] < keys[b] || (keys[a] == keys[b] && a < b); });
+}
+
+void WalkingLocator::LocateRun(const geometry::Point* pts, const int* order, int cnt, int* out) {
+    int hint = -1;
+    for (int i = 0; i < cnt; i++) {
+        hint = (hint == -1) ? Locate(pts[order[i]]) : LocateFrom(pts[order[i]], hint);
+        out[order[i]] = hint;
+    }
+}
+
+int WalkingLocator::Walk(geometry::Point pt, int face) {
+    // Faces can have many edges, so the budget is in edges looked at
+    int budget = kMaxEdges;
+    while (true) {
+        // A face is on the right of its half-edges, the query is inside once none has it on the left
+        int first = face_edge[face];
+        if (first == Dcel::kNone) return Dcel::kNone;
+        int next_face = Dcel::kNone;
+        int he = first;
+        do {
+            if (--budget < 0) return Dcel::kNone;
+            if (geometry::Turn(dcel->OriginPoint(he), dcel->OriginPoint(dcel->Twin(he)), pt) > 0) {
+                next_face = dcel->half_edges[dcel->Twin(he)].incident_face;
+                break;
+            }
+            he = dcel->Next(he);
+        } while (he != first && he != Dcel::kNone);
+        if (he == Dcel::kNone) return Dcel::kNone;
+        if (next_face == Dcel::kNone) return face;
+
+        // Outside of the box
+        if (next_face == open_face) return Dcel::kNone;
+        face = next_face;
+    }
+}
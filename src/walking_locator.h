@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include "dcel.h"
+#include "geometry.h"
+#include "point_locator.h"
+
+// Jump-and-walk point location: starts at the face of a nearby point and crosses edges towards the query
+// Faces of both diagrams are convex, so a walk only leaves a face over an edge that has the query on its
+// far side. Queries outside of the box or walks that get long go to another locator instead
+// Batches are sorted along a Z-order curve, so every answer is a hint for the next query
+class WalkingLocator : public PointLocator {
+   public:
+    // Takes ownership of the fallback locator
+    WalkingLocator(PointLocator* fallback);
+    ~WalkingLocator();
+
+    // Preprocess a DCEL, the fallback too
+    void LoadDcel(Dcel* dcel) override;
+
+    // A query without a hint goes to the fallback
+    int Locate(geometry::Point pt) override;
+
+    // Walks from the face of site 'hint', e.g. the answer for a nearby point
+    int LocateFrom(geometry::Point pt, int hint);
+
+   protected:
+    void SortQueries(const geometry::Point* pts, std::vector<int>* order) override;
+    void LocateRun(const geometry::Point* pts, const int* order, int cnt, int* out) override;
+
+   private:
+    // Walks from a face, returns the face holding the point or Dcel::kNone if the walk was given up
+    int Walk(geometry::Point pt, int face);
+
+    // Edges looked at before giving up
+    static const int kMaxEdges = 64;
+
+    PointLocator* fallback;
+    Dcel* dcel;
+    int open_face;
+    std::vector<int> face_edge;  // Some half-edge of every face
+    std::vector<int> site_face;  // Face of every site
+};
@@ -0,0 +1,276 @@
+#include "width_evaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WIDTH_EVALUATOR_X86
+#endif
+
+namespace {
+
+// Points per tile when scanning for a block of centers, x and y of a tile take 32KB
+const int kTile = 2048;
+
+// Scans points [0, n) for one center and folds the result into 'min_sq' and 'max_sq'
+typedef void (*ScanFn)(const double* xs, const double* ys, int n, double cx, double cy, double* min_sq,
+                       double* max_sq);
+
+void ScanScalar(const double* xs, const double* ys, int n, double cx, double cy, double* min_sq, double* max_sq) {
+    double lo = *min_sq, hi = *max_sq;
+    for (int i = 0; i < n; i++) {
+        double dx = xs[i] - cx, dy = ys[i] - cy;
+        double d = dx * dx + dy * dy;
+        lo = std::min(lo, d);
+        hi = std::max(hi, d);
+    }
+    *min_sq = lo;
+    *max_sq = hi;
+}
+
+// Scans all points for one center, keeping the first index of the min and of the max
+// Lanes of the vector versions see every 2nd or 4th point, so each lane keeps its first index and ties
+// between lanes go to the smaller index
+typedef void (*ArgScanFn)(const double* xs, const double* ys, int n, double cx, double cy, int* min_idx,
+                          int* max_idx, double* min_sq, double* max_sq);
+
+void ArgScanScalar(const double* xs, const double* ys, int n, double cx, double cy, int* min_idx, int* max_idx,
+                   double* min_sq, double* max_sq) {
+    for (int i = 0; i < n; i++) {
+        double dx = xs[i] - cx, dy = ys[i] - cy;
+        double d = dx * dx + dy * dy;
+        if (*min_idx == -1 || d < *min_sq) {
+            *min_sq = d;
+            *min_idx = i;
+        }
+        if (*max_idx == -1 || d > *max_sq) {
+            *max_sq = d;
+            *max_idx = i;
+        }
+    }
+}
+
+// Folds the lanes of the vector versions, indices are kept as doubles, which hold them exactly
+void FoldLanes(int lanes, const double* lo, const double* lo_idx, const double* hi, const double* hi_idx,
+               int* min_idx, int* max_idx, double* min_sq, double* max_sq) {
+    for (int l = 0; l < lanes; l++) {
+        if (lo_idx[l] < 0) continue;
+        int idx = static_cast<int>(lo_idx[l]);
+        if (*min_idx == -1 || lo[l] < *min_sq || (lo[l] == *min_sq && idx < *min_idx)) {
+            *min_sq = lo[l];
+            *min_idx = idx;
+        }
+        idx = static_cast<int>(hi_idx[l]);
+        if (*max_idx == -1 || hi[l] > *max_sq || (hi[l] == *max_sq && idx < *max_idx)) {
+            *max_sq = hi[l];
+            *max_idx = idx;
+        }
+    }
+}
+
+// The scalar tail comes after all vector lanes, so it only wins strictly
+void ArgScanTail(const double* xs, const double* ys, int begin, int n, double cx, double cy, int* min_idx,
+                 int* max_idx, double* min_sq, double* max_sq) {
+    int tail_min = -1, tail_max = -1;
+    double tail_min_sq, tail_max_sq;
+    ArgScanScalar(xs + begin, ys + begin, n - begin, cx, cy, &tail_min, &tail_max, &tail_min_sq, &tail_max_sq);
+    if (tail_min != -1 && (*min_idx == -1 || tail_min_sq < *min_sq)) {
+        *min_sq = tail_min_sq;
+        *min_idx = begin + tail_min;
+    }
+    if (tail_max != -1 && (*max_idx == -1 || tail_max_sq > *max_sq)) {
+        *max_sq = tail_max_sq;
+        *max_idx = begin + tail_max;
+    }
+}
+
+#ifdef WIDTH_EVALUATOR_X86
+
+// Two independent accumulators per bound hide the latency of min and max
+__attribute__((target("sse2"))) void ScanSse2(const double* xs, const double* ys, int n, double cx, double cy,
+                                              double* min_sq, double* max_sq) {
+    __m128d vcx = _mm_set1_pd(cx), vcy = _mm_set1_pd(cy);
+    __m128d lo0 = _mm_set1_pd(*min_sq), lo1 = lo0;
+    __m128d hi0 = _mm_set1_pd(*max_sq), hi1 = hi0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d dx0 = _mm_sub_pd(_mm_loadu_pd(xs + i), vcx);
+        __m128d dy0 = _mm_sub_pd(_mm_loadu_pd(ys + i), vcy);
+        __m128d dx1 = _mm_sub_pd(_mm_loadu_pd(xs + i + 2), vcx);
+        __m128d dy1 = _mm_sub_pd(_mm_loadu_pd(ys + i + 2), vcy);
+        __m128d d0 = _mm_add_pd(_mm_mul_pd(dx0, dx0), _mm_mul_pd(dy0, dy0));
+        __m128d d1 = _mm_add_pd(_mm_mul_pd(dx1, dx1), _mm_mul_pd(dy1, dy1));
+        lo0 = _mm_min_pd(lo0, d0);
+        lo1 = _mm_min_pd(lo1, d1);
+        hi0 = _mm_max_pd(hi0, d0);
+        hi1 = _mm_max_pd(hi1, d1);
+    }
+    double lo[2], hi[2];
+    _mm_storeu_pd(lo, _mm_min_pd(lo0, lo1));
+    _mm_storeu_pd(hi, _mm_max_pd(hi0, hi1));
+    *min_sq = std::min(lo[0], lo[1]);
+    *max_sq = std::max(hi[0], hi[1]);
+    ScanScalar(xs + i, ys + i, n - i, cx, cy, min_sq, max_sq);
+}
+
+__attribute__((target("avx"))) void ScanAvx(const double* xs, const double* ys, int n, double cx, double cy,
+                                            double* min_sq, double* max_sq) {
+    __m256d vcx = _mm256_set1_pd(cx), vcy = _mm256_set1_pd(cy);
+    __m256d lo0 = _mm256_set1_pd(*min_sq), lo1 = lo0;
+    __m256d hi0 = _mm256_set1_pd(*max_sq), hi1 = hi0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d dx0 = _mm256_sub_pd(_mm256_loadu_pd(xs + i), vcx);
+        __m256d dy0 = _mm256_sub_pd(_mm256_loadu_pd(ys + i), vcy);
+        __m256d dx1 = _mm256_sub_pd(_mm256_loadu_pd(xs + i + 4), vcx);
+        __m256d dy1 = _mm256_sub_pd(_mm256_loadu_pd(ys + i + 4), vcy);
+        __m256d d0 = _mm256_add_pd(_mm256_mul_pd(dx0, dx0), _mm256_mul_pd(dy0, dy0));
+        __m256d d1 = _mm256_add_pd(_mm256_mul_pd(dx1, dx1), _mm256_mul_pd(dy1, dy1));
+        lo0 = _mm256_min_pd(lo0, d0);
+        lo1 = _mm256_min_pd(lo1, d1);
+        hi0 = _mm256_max_pd(hi0, d0);
+        hi1 = _mm256_max_pd(hi1, d1);
+    }
+    double lo[4], hi[4];
+    _mm256_storeu_pd(lo, _mm256_min_pd(lo0, lo1));
+    _mm256_storeu_pd(hi, _mm256_max_pd(hi0, hi1));
+    *min_sq = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+    *max_sq = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+    ScanScalar(xs + i, ys + i, n - i, cx, cy, min_sq, max_sq);
+}
+
+// SSE2 has no blend, masks select with and/andnot/or
+__attribute__((target("sse2"))) __m128d Select(__m128d mask, __m128d a, __m128d b) {
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+__attribute__((target("sse2"))) void ArgScanSse2(const double* xs, const double* ys, int n, double cx, double cy,
+                                                 int* min_idx, int* max_idx, double* min_sq, double* max_sq) {
+    __m128d vcx = _mm_set1_pd(cx), vcy = _mm_set1_pd(cy);
+    __m128d idx = _mm_set_pd(1, 0), step = _mm_set1_pd(2);
+    __m128d lo = _mm_set1_pd(std::numeric_limits<double>::infinity()), lo_idx = _mm_set1_pd(-1);
+    __m128d hi = _mm_set1_pd(-1), hi_idx = _mm_set1_pd(-1);
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), vcx);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), vcy);
+        __m128d d = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        __m128d lt = _mm_cmplt_pd(d, lo), gt = _mm_cmpgt_pd(d, hi);
+        lo = Select(lt, d, lo);
+        lo_idx = Select(lt, idx, lo_idx);
+        hi = Select(gt, d, hi);
+        hi_idx = Select(gt, idx, hi_idx);
+        idx = _mm_add_pd(idx, step);
+    }
+    double lo_arr[2], lo_idx_arr[2], hi_arr[2], hi_idx_arr[2];
+    _mm_storeu_pd(lo_arr, lo);
+    _mm_storeu_pd(lo_idx_arr, lo_idx);
+    _mm_storeu_pd(hi_arr, hi);
+    _mm_storeu_pd(hi_idx_arr, hi_idx);
+    FoldLanes(2, lo_arr, lo_idx_arr, hi_arr, hi_idx_arr, min_idx, max_idx, min_sq, max_sq);
+    ArgScanTail(xs, ys, i, n, cx, cy, min_idx, max_idx, min_sq, max_sq);
+}
+
+__attribute__((target("avx"))) void ArgScanAvx(const double* xs, const double* ys, int n, double cx, double cy,
+                                               int* min_idx, int* max_idx, double* min_sq, double* max_sq) {
+    __m256d vcx = _mm256_set1_pd(cx), vcy = _mm256_set1_pd(cy);
+    __m256d idx = _mm256_set_pd(3, 2, 1, 0), step = _mm256_set1_pd(4);
+    __m256d lo = _mm256_set1_pd(std::numeric_limits<double>::infinity()), lo_idx = _mm256_set1_pd(-1);
+    __m256d hi = _mm256_set1_pd(-1), hi_idx = _mm256_set1_pd(-1);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), vcx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), vcy);
+        __m256d d = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        __m256d lt = _mm256_cmp_pd(d, lo, _CMP_LT_OQ), gt = _mm256_cmp_pd(d, hi, _CMP_GT_OQ);
+        lo = _mm256_blendv_pd(lo, d, lt);
+        lo_idx = _mm256_blendv_pd(lo_idx, idx, lt);
+        hi = _mm256_blendv_pd(hi, d, gt);
+        hi_idx = _mm256_blendv_pd(hi_idx, idx, gt);
+        idx = _mm256_add_pd(idx, step);
+    }
+    double lo_arr[4], lo_idx_arr[4], hi_arr[4], hi_idx_arr[4];
+    _mm256_storeu_pd(lo_arr, lo);
+    _mm256_storeu_pd(lo_idx_arr, lo_idx);
+    _mm256_storeu_pd(hi_arr, hi);
+    _mm256_storeu_pd(hi_idx_arr, hi_idx);
+    FoldLanes(4, lo_arr, lo_idx_arr, hi_arr, hi_idx_arr, min_idx, max_idx, min_sq, max_sq);
+    ArgScanTail(xs, ys, i, n, cx, cy, min_idx, max_idx, min_sq, max_sq);
+}
+
+#endif
+
+ScanFn GetScan(WidthEvaluator::Isa isa) {
+#ifdef WIDTH_EVALUATOR_X86
+    if (isa == WidthEvaluator::kAvx) return ScanAvx;
+    if (isa == WidthEvaluator::kSse2) return ScanSse2;
+#endif
+    return ScanScalar;
+}
+
+ArgScanFn GetArgScan(WidthEvaluator::Isa isa) {
+#ifdef WIDTH_EVALUATOR_X86
+    if (isa == WidthEvaluator::kAvx) return ArgScanAvx;
+    if (isa == WidthEvaluator::kSse2) return ArgScanSse2;
+#endif
+    return ArgScanScalar;
+}
+
+}  // namespace
+
+WidthEvaluator::WidthEvaluator(const std::vector<geometry::Point>& points) {
+    xs.reserve(points.size());
+    ys.reserve(points.size());
+    for (const geometry::Point& pt : points) {
+        xs.push_back(pt.x);
+        ys.push_back(pt.y);
+    }
+    isa = BestIsa();
+}
+
+WidthEvaluator::Isa WidthEvaluator::BestIsa() {
+#ifdef WIDTH_EVALUATOR_X86
+    if (__builtin_cpu_supports("avx")) return kAvx;
+    if (__builtin_cpu_supports("sse2")) return kSse2;
+#endif
+    return kScalar;
+}
+
+void WidthEvaluator::MinMaxSquaredDist(geometry::Point center, double* min_sq, double* max_sq) const {
+    MinMaxSquaredDist(&center, 1, min_sq, max_sq);
+}
+
+void WidthEvaluator::MinMaxSquaredDist(const geometry::Point* centers, int cnt, double* min_sq,
+                                       double* max_sq) const {
+    ScanFn scan = GetScan(isa);
+    std::fill(min_sq, min_sq + cnt, std::numeric_limits<double>::infinity());
+    std::fill(max_sq, max_sq + cnt, 0.0);
+    int n = xs.size();
+    int tile = (cnt == 1) ? n : kTile;
+    for (int begin = 0; begin < n; begin += tile) {
+        int sz = std::min(tile, n - begin);
+        for (int i = 0; i < cnt; i++) {
+            scan(xs.data() + begin, ys.data() + begin, sz, centers[i].x, centers[i].y, &min_sq[i], &max_sq[i]);
+        }
+    }
+}
+
+void WidthEvaluator::ArgMinMaxSquaredDist(geometry::Point center, int* min_idx, int* max_idx, double* min_sq,
+                                          double* max_sq) const {
+    *min_idx = *max_idx = -1;
+    *min_sq = std::numeric_limits<double>::infinity();
+    *max_sq = 0;
+    GetArgScan(isa)(xs.data(), ys.data(), xs.size(), center.x, center.y, min_idx, max_idx, min_sq, max_sq);
+}
+
+geometry::Annulus WidthEvaluator::Enclose(geometry::Point center) const {
+    double min_sq, max_sq;
+    MinMaxSquaredDist(center, &min_sq, &max_sq);
+    geometry::Annulus ann;
+    ann.center = center;
+    ann.r_inner = std::sqrt(min_sq);
+    ann.r_outer = std::sqrt(max_sq);
+    return ann;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include "geometry.h"
+
+// Finds the smallest and the biggest squared distance from a center to a fixed set of points,
+// i.e. the annulus around that center that just encloses all of them
+// The points are copied into separate x and y arrays once, so scans run over plain doubles with the widest
+// vector instructions the CPU has. Scans only read, so they can run concurrently
+class WidthEvaluator {
+   public:
+    // Vector instructions to scan with, AVX is enough for 4 doubles at a time
+    enum Isa { kScalar, kSse2, kAvx };
+
+    WidthEvaluator(const std::vector<geometry::Point>& points);
+
+    // The widest instructions this CPU supports, used by default
+    static Isa BestIsa();
+
+    Isa GetIsa() const { return isa; }
+
+    // Forces the instructions to use (e.g. to compare them), 'isa' has to be supported
+    void SetIsa(Isa isa) { this->isa = isa; }
+
+    // Min and max squared distance from a center to all points
+    void MinMaxSquaredDist(geometry::Point center, double* min_sq, double* max_sq) const;
+
+    // The same for a block of centers, the points are scanned in tiles that stay in cache for all of them
+    void MinMaxSquaredDist(const geometry::Point* centers, int cnt, double* min_sq, double* max_sq) const;
+
+    // Same as for one center, and also the first of the nearest and the first of the farthest points
+    void ArgMinMaxSquaredDist(geometry::Point center, int* min_idx, int* max_idx, double* min_sq,
+                              double* max_sq) const;
+
+    // The enclosing annulus around a center
+    geometry::Annulus Enclose(geometry::Point center) const;
+
+   private:
+    std::vector<double> xs, ys;
+    Isa isa;
+};
@@ -85,6 +85,10 @@ void Window::Draw(int tick_ms) {
                     mode = CANDIDATES;
                 } else if (event.key.code == sf::Keyboard::Num5) {
                     mode = ANNULUS;
+                } else if (event.key.code == sf::Keyboard::Space) {
+                    // Next step, if stepping through the algorithms
+                    model->GetVoronoiPacer()->Advance();
+                    model->GetFpVoronoiPacer()->Advance();
                 }
             }
             if (event.type == sf::Event::MouseWheelMoved) {
@@ -169,15 +173,15 @@ void Window::SaveToPhoto(const std::string& filename) {
 void Window::DrawFaces(Dcel* dcel, const std::vector<sf::Color>& colors) {
     // Draw faces
     int idx = 0;
-    for (Dcel::HalfEdge* he : dcel->faces.back()->inner_components) {
-        Dcel::HalfEdge* curr = he;
+    for (int he : dcel->faces.back().inner_components) {
+        int curr = he;
         sf::ConvexShape poly;
 
         // Find the number of polygon vertices
         int nb = 0;
         do {
             nb++;
-            curr = curr->next;
+            curr = dcel->half_edges[curr].next;
         } while (curr != he);
         poly.setPointCount(nb);
 
@@ -185,9 +189,10 @@ void Window::DrawFaces(Dcel* dcel, const std::vector<sf::Color>& colors) {
         curr = he;
         nb = 0;
         do {
-            poly.setPoint(nb, sf::Vector2f(curr->origin->point.x, -curr->origin->point.y));
+            geometry::Point origin = dcel->OriginPoint(curr);
+            poly.setPoint(nb, sf::Vector2f(origin.x, -origin.y));
             nb++;
-            curr = curr->next;
+            curr = dcel->half_edges[curr].next;
         } while (curr != he);
 
         // Draw
@@ -219,11 +224,12 @@ void Window::DrawSites(sf::Color color) {
 void Window::DrawVertices(Dcel* dcel, sf::Color color) {
     int n = dcel->vertices.size();
     for (int i = 0; i < n; i++) {
-        if (mode == CANDIDATES && dcel->vertices[i]->box) continue;
+        if (mode == CANDIDATES && dcel->vertices[i].box) continue;
+        if (dcel->vertices[i].removed) continue;
         // Draw a DCEL vertex
         double radius = 2;
         sf::CircleShape vertex(radius);
-        vertex.setPosition(dcel->vertices[i]->point.x - radius, -dcel->vertices[i]->point.y - radius);
+        vertex.setPosition(dcel->vertices[i].point.x - radius, -dcel->vertices[i].point.y - radius);
         vertex.setFillColor(color);
         window->draw(vertex);
     }
@@ -231,14 +237,16 @@ void Window::DrawVertices(Dcel* dcel, sf::Color color) {
 
 void Window::DrawEdges(Dcel* dcel, sf::Color color) {
     int n = dcel->half_edges.size();
-    for (int i = 0; i < n; i++) {
-        Dcel::HalfEdge* he = dcel->half_edges[i];
-        Dcel::HalfEdge* twin = he->twin;
-        if (he->origin != nullptr && twin->origin != nullptr) {
+    for (int he = 0; he < n; he++) {
+        if (dcel->half_edges[he].removed) continue;
+        int twin = dcel->Twin(he);
+        if (dcel->Origin(he) != Dcel::kNone && dcel->Origin(twin) != Dcel::kNone) {
             // Draw a DCEL half-edge
+            geometry::Point from = dcel->OriginPoint(he);
+            geometry::Point to = dcel->OriginPoint(twin);
             sf::Vertex edge[] = {
-                sf::Vertex(sf::Vector2f(he->origin->point.x, -he->origin->point.y), color),
-                sf::Vertex(sf::Vector2f(twin->origin->point.x, -twin->origin->point.y), color),
+                sf::Vertex(sf::Vector2f(from.x, -from.y), color),
+                sf::Vertex(sf::Vector2f(to.x, -to.y), color),
             };
             window->draw(edge, 2, sf::Lines);
         }
@@ -246,7 +254,7 @@ void Window::DrawEdges(Dcel* dcel, sf::Color color) {
 }
 
 void Window::DrawCandidates(sf::Color color) {
-    for (auto candidate : model->GetCandidates()) {
+    for (const geometry::Annulus& candidate : model->GetCandidates()) {
         // Draw a DCEL vertex
         double radius = 2;
         sf::CircleShape vertex(radius);